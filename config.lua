@@ -46,6 +46,18 @@ SHOW_SYNC=false
 
 CRT_MONITOR=false
 
+-- show audio latency and
+-- rate control stats
+AUDIO_STATS=false
+
+-- rasterize the screen on
+-- worker threads, 0 is off
+DRAW_THREADS=0
+
+-- keep the last frames played,
+-- hold F10 to step back
+REWIND=false
+
 UI_SCALE=4
 
 ---------------------------
@@ -62,6 +62,13 @@ typedef struct
 
 	u32* screen;
 	tic80_pixel_color_format screen_format;
+
+	// rows of screen changed by the last tick, none when top == bottom
+	struct
+	{
+		s32 top;
+		s32 bottom;
+	} screen_dirty;
 	
 } tic80;
 
@@ -139,6 +146,35 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size);
 TIC80_API void tic80_tick(tic80* tic, const tic80_input* input);
 TIC80_API void tic80_delete(tic80* tic);
 
+// snapshot of the running machine, NULL buffer gives the size it needs; returns 0 if the script can't be saved
+TIC80_API s32 tic80_save_state(tic80* tic, void* buffer, s32 size);
+// restores a snapshot taken from an instance running the same cart
+TIC80_API bool tic80_load_state(tic80* tic, const void* buffer, s32 size);
+// shows the screen frames ticks ahead: ticks them silently with the same input and goes back to the saved machine,
+// call it after tic80_tick once its sound is played; returns false if the script state can't be saved or restored,
+// run ahead is then off for the rest of the session
+TIC80_API bool tic80_tick_ahead(tic80* tic, const tic80_input* input, s32 frames);
+
+// records the draw calls of a tick and rasterizes them on threads workers besides the calling thread, 0 draws right away
+TIC80_API void tic80_draw_threads(tic80* tic, s32 threads);
+
+typedef struct tic80_cart tic80_cart;
+
+// a cart loaded once and run by any number of instances without a copy of their own,
+// delete it after the instances that run it
+TIC80_API tic80_cart* tic80_cart_create(void* cart, s32 size);
+TIC80_API void tic80_load_cart(tic80* tic, const tic80_cart* cart);
+TIC80_API void tic80_cart_delete(tic80_cart* cart);
+
+typedef struct tic80_batch tic80_batch;
+
+// steps many instances in parallel, threads are the workers besides the calling thread
+TIC80_API tic80_batch* tic80_batch_create(s32 threads);
+// ticks every instance frames times with its own input, instances are shared out to the workers as they get free;
+// output can be NULL, otherwise instances with output[i] == false skip sound synthesis and the screen blit
+TIC80_API void tic80_batch_tick(tic80_batch* batch, tic80** tics, const tic80_input* inputs, const bool* output, s32 count, s32 frames);
+TIC80_API void tic80_batch_delete(tic80_batch* batch);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,36 @@ static void readConfigCrtMonitor(Config* config, lua_State* lua)
     lua_pop(lua, 1);
 }
 
+static void readConfigAudioStats(Config* config, lua_State* lua)
+{
+    lua_getglobal(lua, "AUDIO_STATS");
+
+    if(lua_isboolean(lua, -1))
+        config->data.audioStats = lua_toboolean(lua, -1);
+
+    lua_pop(lua, 1);
+}
+
+static void readConfigDrawThreads(Config* config, lua_State* lua)
+{
+    lua_getglobal(lua, "DRAW_THREADS");
+
+    if(lua_isinteger(lua, -1))
+        config->data.drawThreads = lua_tointeger(lua, -1);
+
+    lua_pop(lua, 1);
+}
+
+static void readConfigRewind(Config* config, lua_State* lua)
+{
+    lua_getglobal(lua, "REWIND");
+
+    if(lua_isboolean(lua, -1))
+        config->data.rewind = lua_toboolean(lua, -1);
+
+    lua_pop(lua, 1);
+}
+
 static void readConfigUiScale(Config* config, lua_State* lua)
 {
     lua_getglobal(lua, "UI_SCALE");
@@ -278,6 +308,9 @@ static void readConfig(Config* config)
             readConfigNoSound(config, lua);
             readConfigShowSync(config, lua);
             readConfigCrtMonitor(config, lua);
+            readConfigAudioStats(config, lua);
+            readConfigDrawThreads(config, lua);
+            readConfigRewind(config, lua);
             readConfigUiScale(config, lua);
             readTheme(config, lua);
             readConfigCrtShader(config, lua);
@@ -343,7 +376,7 @@ static void reset(Config* config)
 
 static void save(Config* config)
 {
-    memcpy(&config->cart, &config->tic->cart, sizeof(tic_cartridge));
+    memcpy(&config->cart, config->tic->cart, sizeof(tic_cartridge));
     readConfig(config);
     saveConfig(config, true);
 
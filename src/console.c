@@ -26,6 +26,7 @@
 #include "ext/gif.h"
 #include "ext/file_dialog.h"
 #include "project.h"
+#include "jobs.h"
 
 #include <ctype.h>
 #include <string.h>
@@ -384,7 +385,7 @@ static s32 writeGifData(const tic_mem* tic, u8* dst, const u8* src, s32 width, s
 
 static bool loadRom(tic_mem* tic, const void* data, s32 size)
 {
-    tic_cart_load(&tic->cart, data, size);
+    tic_cart_load(tic->cart, data, size);
     tic_api_reset(tic);
 
     return true;
@@ -432,13 +433,13 @@ static bool onConsoleLoadSectionCommand(Console* console, const char* param)
 
                         switch(i)
                         {
-                        case 0: memcpy(&tic->cart.cover,            &cart->cover,           sizeof cart->cover); break;
-                        case 1: memcpy(&tic->cart.bank0.tiles,      &cart->bank0.tiles,     sizeof(tic_tiles)*2); break;
-                        case 2: memcpy(&tic->cart.bank0.map,        &cart->bank0.map,       sizeof(tic_map)); break;
-                        case 3: memcpy(&tic->cart.code,             &cart->code,            sizeof(tic_code)); break;
-                        case 4: memcpy(&tic->cart.bank0.sfx,        &cart->bank0.sfx,       sizeof(tic_sfx)); break;
-                        case 5: memcpy(&tic->cart.bank0.music,      &cart->bank0.music,     sizeof(tic_music)); break;
-                        case 6: memcpy(&tic->cart.bank0.palette,    &cart->bank0.palette,   sizeof(tic_palette)); break;
+                        case 0: memcpy(&tic->cart->cover,            &cart->cover,           sizeof cart->cover); break;
+                        case 1: memcpy(&tic->cart->bank0.tiles,      &cart->bank0.tiles,     sizeof(tic_tiles)*2); break;
+                        case 2: memcpy(&tic->cart->bank0.map,        &cart->bank0.map,       sizeof(tic_map)); break;
+                        case 3: memcpy(&tic->cart->code,             &cart->code,            sizeof(tic_code)); break;
+                        case 4: memcpy(&tic->cart->bank0.sfx,        &cart->bank0.sfx,       sizeof(tic_sfx)); break;
+                        case 5: memcpy(&tic->cart->bank0.music,      &cart->bank0.music,     sizeof(tic_music)); break;
+                        case 6: memcpy(&tic->cart->bank0.palette,    &cart->bank0.palette,   sizeof(tic_palette)); break;
                         }
 
                         studioRomLoaded();
@@ -700,7 +701,7 @@ static void updateProject(Console* console)
             {
                 if(tic_project_load(console->romName, data, size, cart))
                 {
-                    memcpy(&tic->cart, cart, sizeof(tic_cartridge));
+                    memcpy(tic->cart, cart, sizeof(tic_cartridge));
 
                     studioRomLoaded();
                 }
@@ -758,7 +759,7 @@ static void onConsoleLoadCommandConfirmed(Console* console, const char* param)
 
             void* data = fsLoadFile(console->fs, name, &size);
 
-            if(data && tic_project_load(name, data, size, &console->tic->cart))
+            if(data && tic_project_load(name, data, size, console->tic->cart))
                 onCartLoaded(console, name);
             else printBack(console, "\ncart loading error");
 
@@ -1317,10 +1318,10 @@ static void onImportCover(const char* name, const void* buffer, size_t size, voi
 
                 if(image->width == Width && image->height == Height)
                 {
-                    if(size <= sizeof console->tic->cart.cover.data)
+                    if(size <= sizeof console->tic->cart->cover.data)
                     {
-                        console->tic->cart.cover.size = size;
-                        memcpy(console->tic->cart.cover.data, buffer, size);
+                        console->tic->cart->cover.size = size;
+                        memcpy(console->tic->cart->cover.data, buffer, size);
 
                         printLine(console);
                         printBack(console, name);
@@ -1462,7 +1463,7 @@ static void onCoverExported(GetResult result, void* data)
 
 static void exportCover(Console* console)
 {
-    tic_cover_image* cover = &console->tic->cart.cover;
+    tic_cover_image* cover = &console->tic->cart->cover;
 
     if(cover->size)
     {
@@ -1484,10 +1485,8 @@ static void exportCover(Console* console)
 
 static void exportSfx(Console* console, s32 sfx)
 {
-    const char* path = studioExportSfx(sfx);
-
     s32 size = 0;
-    void* data = fsLoadRootFile(console->fs, path, &size);
+    void* data = studioExportSfx(sfx, &size);
 
     if(data)
     {
@@ -1504,10 +1503,8 @@ static void exportSfx(Console* console, s32 sfx)
 
 static void exportMusic(Console* console, s32 track)
 {
-    const char* path = studioExportMusic(track);
-
     s32 size = 0;
-    void* data = fsLoadRootFile(console->fs, path, &size);
+    void* data = studioExportMusic(track, &size);
 
     if(data)
     {
@@ -1522,6 +1519,252 @@ static void exportMusic(Console* console, s32 track)
     }
 }
 
+typedef struct
+{
+    tic_mem** machines;
+    s32 count;
+    const tic_bank* bank;
+
+    // tracks go first, they take longest
+    struct
+    {
+        void* data;
+        s32 size;
+    } wavs[MUSIC_TRACKS + SFX_COUNT];
+} AudioExport;
+
+static bool isZeroed(const void* data, s32 size)
+{
+    const u8* ptr = data;
+
+    for(s32 i = 0; i < size; i++)
+        if(ptr[i]) return false;
+
+    return true;
+}
+
+static void exportAudioJob(void* data, s32 index)
+{
+    AudioExport* audio = data;
+    tic_mem* tic = audio->machines[index];
+
+    enum{Channels = (1 << TIC_SOUND_CHANNELS) - 1};
+
+    memcpy(&tic->ram.sfx, &audio->bank->sfx, sizeof(tic_sfx));
+    memcpy(&tic->ram.music, &audio->bank->music, sizeof(tic_music));
+    tic_core_invalidate(tic, offsetof(tic_ram, sfx), sizeof(tic_sfx));
+    tic_core_invalidate(tic, offsetof(tic_ram, music), sizeof(tic_music));
+
+    // every machine takes every count-th sound, untouched tracks and samples are skipped
+    for(s32 i = index; i < COUNT_OF(audio->wavs); i += audio->count)
+    {
+        s32* size = &audio->wavs[i].size;
+
+        if(i < MUSIC_TRACKS)
+        {
+            const tic_track* track = &audio->bank->music.tracks.data[i];
+
+            audio->wavs[i].data = isZeroed(track->data, sizeof track->data) ? NULL
+                : studioRenderMusic(tic, TIC80_SAMPLERATE, i, false, Channels, size);
+        }
+        else
+        {
+            s32 sfx = i - MUSIC_TRACKS;
+            const tic_sample* effect = &audio->bank->sfx.samples.data[sfx];
+
+            audio->wavs[i].data = isZeroed(effect, sizeof(tic_sample)) ? NULL
+                : studioRenderSfx(tic, TIC80_SAMPLERATE, sfx, size);
+        }
+    }
+}
+
+static bool loadAudioCart(Console* console, const char* name, tic_cartridge* cart)
+{
+    s32 size = 0;
+    bool done = false;
+
+    if(hasProjectExt(name))
+    {
+        void* data = fsLoadFile(console->fs, name, &size);
+        done = data && tic_project_load(name, data, size, cart);
+        free(data);
+    }
+    else
+    {
+        void* data = fsLoadFile(console->fs, getCartName(name), &size);
+
+        if(data)
+        {
+            tic_cart_load(cart, data, size);
+            done = true;
+        }
+
+        free(data);
+    }
+
+    return done;
+}
+
+// renders the sounds of the cart first bank on all the machines at once and saves them next to it
+static void exportCartAudio(Console* console, tic_jobs* jobs, AudioExport* audio, const tic_cartridge* cart, const char* name)
+{
+    char prefix[TICNAME_MAX] = {0};
+
+    if(name)
+    {
+        const char* ext = strrchr(name, '.');
+        s32 len = ext ? (s32)(ext - name) : (s32)strlen(name);
+
+        // the longest file name has to fit as well
+        if(len + sizeof " track 00.wav" > sizeof prefix)
+        {
+            printError(console, "\ncart name is too long: ");
+            printError(console, name);
+            return;
+        }
+
+        snprintf(prefix, sizeof prefix, "%.*s ", len, name);
+    }
+
+    audio->bank = &cart->bank0;
+    tic_jobs_run(jobs, exportAudioJob, audio, audio->count);
+
+    s32 files = 0;
+
+    for(s32 i = 0; i < COUNT_OF(audio->wavs); i++)
+    {
+        if(audio->wavs[i].data)
+        {
+            char path[TICNAME_MAX];
+
+            if(i < MUSIC_TRACKS)
+                snprintf(path, sizeof path, "%strack %i.wav", prefix, i);
+            else
+                snprintf(path, sizeof path, "%ssfx %i.wav", prefix, i - MUSIC_TRACKS);
+
+            if(fsSaveFile(console->fs, path, audio->wavs[i].data, audio->wavs[i].size, true))
+                files++;
+            else
+            {
+                printError(console, "\nfile not saved: ");
+                printError(console, path);
+            }
+
+            free(audio->wavs[i].data);
+        }
+    }
+
+    char message[TICNAME_MAX];
+    snprintf(message, sizeof message, "\n%s: %i files exported", name ? name : "cart", files);
+    printBack(console, message);
+}
+
+// cuts the next name off a list of names separated by spaces, a name with spaces is quoted; NULL at the end
+static char* nextParamName(char** list)
+{
+    char* name = *list;
+
+    while(*name == ' ')
+        name++;
+
+    if(!*name)
+        return NULL;
+
+    char* end = *name == '"' ? strchr(++name, '"') : strchr(name, ' ');
+
+    if(end)
+    {
+        *end = '\0';
+        *list = end + 1;
+    }
+    else *list = name + strlen(name);
+
+    return name;
+}
+
+static void exportAudioCart(Console* console, tic_jobs* jobs, AudioExport* audio, tic_cartridge* cart, const char* name)
+{
+    if(loadAudioCart(console, name, cart))
+        exportCartAudio(console, jobs, audio, cart, name);
+    else
+    {
+        printError(console, "\ncart loading error: ");
+        printError(console, name);
+    }
+}
+
+// false when a machine can't be created, the ones that were are closed again
+static bool createAudioMachines(tic_mem** machines, s32 count)
+{
+    for(s32 i = 0; i < count; i++)
+    {
+        machines[i] = tic_core_create(TIC80_SAMPLERATE);
+
+        if(!machines[i])
+        {
+            while(i--)
+                tic_core_close(machines[i]);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// export audio [cart ...], without carts it takes the loaded one; like load, the whole line
+// can be the name of one cart, names with spaces in a list are quoted
+static void exportAudio(Console* console, const char* param)
+{
+    tic_jobs* jobs = tic_jobs_create(tic_jobs_cores() - 1);
+    s32 count = tic_jobs_threads(jobs) + 1;
+
+    AudioExport* audio = calloc(1, sizeof(AudioExport));
+    tic_mem** machines = calloc(count, sizeof(tic_mem*));
+
+    if(jobs && audio && machines && createAudioMachines(machines, count))
+    {
+        *audio = (AudioExport){.machines = machines, .count = count};
+
+        while(*param == ' ')
+            param++;
+
+        if(!*param)
+            exportCartAudio(console, jobs, audio, console->tic->cart, strlen(console->romName) ? console->romName : NULL);
+        else
+        {
+            tic_cartridge* cart = malloc(sizeof(tic_cartridge));
+
+            if(!cart)
+                printMemoryError(console);
+            else if(loadAudioCart(console, param, cart))
+                exportCartAudio(console, jobs, audio, cart, param);
+            else
+            {
+                char* names = strdup(param);
+                char* list = names;
+
+                for(const char* name = nextParamName(&list); name; name = nextParamName(&list))
+                    exportAudioCart(console, jobs, audio, cart, name);
+
+                free(names);
+            }
+
+            free(cart);
+        }
+
+        for(s32 i = 0; i < count; i++)
+            tic_core_close(machines[i]);
+    }
+    else printMemoryError(console);
+
+    free(machines);
+    free(audio);
+    tic_jobs_close(jobs);
+
+    commandDone(console);
+}
+
 static void exportSprites(Console* console)
 {
     enum
@@ -1649,7 +1892,7 @@ static void* embedCart(Console* console, s32* size)
 
         if(cart)
         {
-            s32 cartSize = tic_cart_save(&tic->cart, cart);
+            s32 cartSize = tic_cart_save(tic->cart, cart);
 
             unsigned long zipSize = sizeof(tic_cartridge);
             u8* zipData = (u8*)malloc(zipSize);
@@ -1820,7 +2063,7 @@ static void onConsoleExportHtmlCommand(Console* console, const char* providedNam
 
             if(cart)
             {
-                s32 cartSize = tic_cart_save(&tic->cart, cart);
+                s32 cartSize = tic_cart_save(tic->cart, cart);
 
                 zip_entry_open(zip, "cart.tic");
                 zip_entry_write(zip, cart, cartSize);
@@ -1929,6 +2172,10 @@ static void onConsoleExportCommand(Console* console, const char* param)
         {
             exportMusic(console, 0);
         }
+        else if(strncmp(param, "audio", 5) == 0 && (param[5] == ' ' || param[5] == 0))
+        {
+            exportAudio(console, param + 5);
+        }
         else if(strcmp(param, "music ") > 0)
         {
             s32 track = atoi(param + sizeof("music"));
@@ -1980,12 +2227,12 @@ static CartSaveResult saveCartName(Console* console, const char* name)
 
                 if(hasProjectExt(name))
                 {
-                    size = tic_project_save(name, buffer, &tic->cart);
+                    size = tic_project_save(name, buffer, tic->cart);
                 }
                 else
                 {
                     name = getCartName(name);
-                    size = tic_cart_save(&tic->cart, buffer);
+                    size = tic_cart_save(tic->cart, buffer);
                 }
 
                 if(size && fsSaveFile(console->fs, name, buffer, size, true))
@@ -2070,7 +2317,7 @@ static void onConsoleResumeCommand(Console* console, const char* param)
     const tic_script_config* script_config = tic_core_script_config(console->tic);
     if (script_config->eval && console->codeLiveReload.active)
     {
-        script_config->eval(console->tic, console->tic->cart.code.data);
+        script_config->eval(console->tic, console->tic->cart->code.data);
     }
     tic_core_resume(console->tic);
 
@@ -2798,7 +3045,7 @@ static void tick(Console* console)
             if(!console->skipStart)
                 console->showGameMenu = true;
 
-            memcpy(&tic->cart, console->embed.file, sizeof(tic_cartridge));
+            memcpy(tic->cart, console->embed.file, sizeof(tic_cartridge));
 
             tic_api_reset(tic);
 
@@ -3186,6 +3433,9 @@ void initConsole(Console* console, tic_mem* tic, FileSystem* fs, Config* config,
                 else if(strcmp(arg, "-crt-monitor") == 0)
                     console->crtMonitor = true;
 
+                else if(strcmp(arg, "-rewind") == 0)
+                    config->data.rewind = true;
+
                 else continue;
 
                 argp |= 0b1 << i;
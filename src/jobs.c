@@ -0,0 +1,289 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "jobs.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#if defined(__EMSCRIPTEN__) || defined(_3DS)
+#   define TIC_JOBS_NO_THREADS
+#elif defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+#define MAX_THREADS 64
+
+#if !defined(TIC_JOBS_NO_THREADS)
+
+#if defined(_WIN32)
+
+typedef HANDLE Thread;
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE Cond;
+
+static void mutexInit(Mutex* mutex) {InitializeSRWLock(mutex);}
+static void mutexFree(Mutex* mutex) {}
+static void mutexLock(Mutex* mutex) {AcquireSRWLockExclusive(mutex);}
+static void mutexUnlock(Mutex* mutex) {ReleaseSRWLockExclusive(mutex);}
+static void condInit(Cond* cond) {InitializeConditionVariable(cond);}
+static void condFree(Cond* cond) {}
+static void condWait(Cond* cond, Mutex* mutex) {SleepConditionVariableSRW(cond, mutex, INFINITE, 0);}
+static void condBroadcast(Cond* cond) {WakeAllConditionVariable(cond);}
+
+#else
+
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+
+static void mutexInit(Mutex* mutex) {pthread_mutex_init(mutex, NULL);}
+static void mutexFree(Mutex* mutex) {pthread_mutex_destroy(mutex);}
+static void mutexLock(Mutex* mutex) {pthread_mutex_lock(mutex);}
+static void mutexUnlock(Mutex* mutex) {pthread_mutex_unlock(mutex);}
+static void condInit(Cond* cond) {pthread_cond_init(cond, NULL);}
+static void condFree(Cond* cond) {pthread_cond_destroy(cond);}
+static void condWait(Cond* cond, Mutex* mutex) {pthread_cond_wait(cond, mutex);}
+static void condBroadcast(Cond* cond) {pthread_cond_broadcast(cond);}
+
+#endif
+
+#endif
+
+struct tic_jobs
+{
+    s32 threads;
+
+#if !defined(TIC_JOBS_NO_THREADS)
+    Thread handles[MAX_THREADS];
+
+    Mutex lock;
+    Cond wake;
+    Cond done;
+
+    tic_job job;
+    void* data;
+    s32 count;
+    s32 next;
+    s32 finished;
+
+    u32 generation;
+    bool quit;
+#endif
+};
+
+#if !defined(TIC_JOBS_NO_THREADS)
+
+// takes jobs of the current batch until none are left, called with the lock held
+static void runJobs(tic_jobs* jobs)
+{
+    while(jobs->next < jobs->count)
+    {
+        s32 index = jobs->next++;
+        tic_job job = jobs->job;
+        void* data = jobs->data;
+
+        mutexUnlock(&jobs->lock);
+        job(data, index);
+        mutexLock(&jobs->lock);
+
+        if(++jobs->finished == jobs->count)
+            condBroadcast(&jobs->done);
+    }
+}
+
+static void workerLoop(tic_jobs* jobs)
+{
+    mutexLock(&jobs->lock);
+
+    for(u32 generation = jobs->generation;;)
+    {
+        while(!jobs->quit && generation == jobs->generation)
+            condWait(&jobs->wake, &jobs->lock);
+
+        if(jobs->quit) break;
+
+        generation = jobs->generation;
+        runJobs(jobs);
+    }
+
+    mutexUnlock(&jobs->lock);
+}
+
+#if defined(_WIN32)
+
+static DWORD WINAPI workerThread(LPVOID data)
+{
+    workerLoop(data);
+    return 0;
+}
+
+static bool startThread(Thread* thread, tic_jobs* jobs)
+{
+    return (*thread = CreateThread(NULL, 0, workerThread, jobs, 0, NULL)) != NULL;
+}
+
+static void joinThread(Thread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#else
+
+static void* workerThread(void* data)
+{
+    workerLoop(data);
+    return NULL;
+}
+
+static bool startThread(Thread* thread, tic_jobs* jobs)
+{
+    return pthread_create(thread, NULL, workerThread, jobs) == 0;
+}
+
+static void joinThread(Thread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+#endif
+
+#endif
+
+tic_jobs* tic_jobs_create(s32 threads)
+{
+    tic_jobs* jobs = calloc(1, sizeof(tic_jobs));
+
+    if(!jobs) return NULL;
+
+#if !defined(TIC_JOBS_NO_THREADS)
+    mutexInit(&jobs->lock);
+    condInit(&jobs->wake);
+    condInit(&jobs->done);
+
+    threads = threads < 0 ? 0 : threads > MAX_THREADS ? MAX_THREADS : threads;
+
+    // keeps as many workers as the system allows to start
+    while(jobs->threads < threads && startThread(&jobs->handles[jobs->threads], jobs))
+        jobs->threads++;
+#endif
+
+    return jobs;
+}
+
+void tic_jobs_close(tic_jobs* jobs)
+{
+    if(!jobs) return;
+
+#if !defined(TIC_JOBS_NO_THREADS)
+    mutexLock(&jobs->lock);
+    jobs->quit = true;
+    condBroadcast(&jobs->wake);
+    mutexUnlock(&jobs->lock);
+
+    for(s32 i = 0; i < jobs->threads; i++)
+        joinThread(jobs->handles[i]);
+
+    condFree(&jobs->done);
+    condFree(&jobs->wake);
+    mutexFree(&jobs->lock);
+#endif
+
+    free(jobs);
+}
+
+s32 tic_jobs_threads(const tic_jobs* jobs)
+{
+    return jobs ? jobs->threads : 0;
+}
+
+s32 tic_jobs_cores()
+{
+#if defined(TIC_JOBS_NO_THREADS)
+    return 1;
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? cores : 1;
+#else
+    return 1;
+#endif
+}
+
+void tic_jobs_run(tic_jobs* jobs, tic_job job, void* data, s32 count)
+{
+    if(tic_jobs_threads(jobs) == 0 || count <= 1)
+    {
+        for(s32 i = 0; i < count; i++)
+            job(data, i);
+
+        return;
+    }
+
+#if !defined(TIC_JOBS_NO_THREADS)
+    mutexLock(&jobs->lock);
+
+    jobs->job = job;
+    jobs->data = data;
+    jobs->count = count;
+    jobs->next = 0;
+    jobs->finished = 0;
+    jobs->generation++;
+    condBroadcast(&jobs->wake);
+
+    runJobs(jobs);
+
+    while(jobs->finished < jobs->count)
+        condWait(&jobs->done, &jobs->lock);
+
+    mutexUnlock(&jobs->lock);
+#endif
+}
+
+s32 tic_atomic_load(const volatile s32* value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#elif defined(_WIN32)
+    return InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#else
+    return *value;
+#endif
+}
+
+void tic_atomic_store(volatile s32* value, s32 data)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(value, data, __ATOMIC_RELEASE);
+#elif defined(_WIN32)
+    InterlockedExchange((volatile LONG*)value, data);
+#else
+    *value = data;
+#endif
+}
@@ -0,0 +1,43 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "tic80_types.h"
+
+typedef struct tic_jobs tic_jobs;
+typedef void(*tic_job)(void* data, s32 index);
+
+// starts a pool of worker threads, without thread support jobs run on the caller
+tic_jobs* tic_jobs_create(s32 threads);
+void tic_jobs_close(tic_jobs* jobs);
+s32 tic_jobs_threads(const tic_jobs* jobs);
+// cores the system runs threads on, 1 without thread support
+s32 tic_jobs_cores();
+
+// calls job(data, i) for every i in [0, count) and returns when all of them are done,
+// the calling thread takes jobs too
+void tic_jobs_run(tic_jobs* jobs, tic_job job, void* data, s32 count);
+
+// counters handed between two threads: a load sees everything the other thread wrote before its store
+s32 tic_atomic_load(const volatile s32* value);
+void tic_atomic_store(volatile s32* value, s32 data);
@@ -147,7 +147,7 @@ static duk_ret_t duk_rectb(duk_context* duk)
 
 static duk_ret_t duk_spr(duk_context* duk)
 {
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     s32 index = duk_opt_int(duk, 0, 0);
@@ -310,7 +310,8 @@ static duk_ret_t duk_sfx(duk_context* duk)
     {
         if(index >= 0)
         {
-            tic_sample* effect = tic->ram.sfx.samples.data + index;
+            tic_core_materialize(tic, offsetof(tic_ram, sfx.samples) + index * sizeof(tic_sample), sizeof(tic_sample));
+            const tic_sample* effect = tic->ram.sfx.samples.data + index;
 
             note = effect->note;
             octave = effect->octave;
@@ -361,7 +362,7 @@ typedef struct
     void* remap;
 } RemapData;
 
-static void remapCallback(void* data, s32 x, s32 y, RemapResult* result)
+static void remapTile(void* data, s32 x, s32 y, RemapResult* result)
 {
 
     RemapData* remap = (RemapData*)data;
@@ -395,6 +396,12 @@ static void remapCallback(void* data, s32 x, s32 y, RemapResult* result)
     duk_pop(duk);
 }
 
+static void remapCallback(void* data, s32 x, s32 y, s32 count, RemapResult* result)
+{
+    for(s32 i = 0; i < count; i++)
+        remapTile(data, x + i, y, result + i);
+}
+
 static duk_ret_t duk_map(duk_context* duk)
 {
     s32 x = duk_opt_int(duk, 0, 0);
@@ -405,7 +412,7 @@ static duk_ret_t duk_map(duk_context* duk)
     s32 sy = duk_opt_int(duk, 5, 0);
     s32 scale = duk_opt_int(duk, 7, 1);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     {
@@ -710,7 +717,7 @@ static duk_ret_t duk_textri(duk_context* duk)
     tic_mem* tic = (tic_mem*)getDukMachine(duk);
     bool use_map = duk_opt_boolean(duk, 12, false);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
     {
         if(!duk_is_null_or_undefined(duk, 13))
@@ -840,14 +847,12 @@ static duk_ret_t duk_fset(duk_context* duk)
     return 0;
 }
 
-static u64 ForceExitCounter = 0;
-
 s32 duk_timeout_check(void* udata)
 {
     tic_machine* machine = (tic_machine*)udata;
     tic_tick_data* tick = machine->data;
 
-    return ForceExitCounter++ > 1000 ? tick->forceExit && tick->forceExit(tick->data) : false;
+    return machine->jsTimeoutChecks++ > 1000 ? tick->forceExit && tick->forceExit(tick->data) : false;
 }
 
 static void initDuktape(tic_machine* machine)
@@ -291,10 +291,76 @@ static s32 lua_tri(lua_State* lua)
     return 0;
 }
 
+static s32 getTextriChroma(lua_State* lua, s32 index, u8* colors)
+{
+    s32 count = 0;
+
+    if(lua_istable(lua, index))
+    {
+        for(s32 i = 1; i <= TIC_PALETTE_SIZE; i++)
+        {
+            lua_rawgeti(lua, index, i);
+            if(lua_isnumber(lua, -1))
+            {
+                colors[i-1] = getLuaNumber(lua, -1);
+                count++;
+                lua_pop(lua, 1);
+            }
+            else
+            {
+                lua_pop(lua, 1);
+                break;
+            }
+        }
+    }
+    else 
+    {
+        colors[0] = getLuaNumber(lua, index);
+        count = 1;
+    }
+
+    return count;
+}
+
+// textri({x1,y1,x2,y2,x3,y3,u1,v1,u2,v2,u3,v3, ...}, [use_map], [chroma]) draws a whole mesh in one call
+static s32 lua_textri_list(lua_State* lua)
+{
+    s32 top = lua_gettop(lua);
+    s32 triangles = (s32)lua_rawlen(lua, 1) / TIC_TEXTRI_FLOATS;
+
+    if(triangles == 0)
+        return 0;
+
+    float* pt = malloc(triangles * TIC_TEXTRI_FLOATS * sizeof(float));
+
+    if(pt)
+    {
+        for(s32 i = 0; i < triangles * TIC_TEXTRI_FLOATS; i++)
+        {
+            lua_rawgeti(lua, 1, i + 1);
+            pt[i] = (float)lua_tonumber(lua, -1);
+            lua_pop(lua, 1);
+        }
+
+        u8 colors[TIC_PALETTE_SIZE];
+        s32 count = top >= 3 ? getTextriChroma(lua, 3, colors) : 0;
+        bool use_map = top >= 2 ? lua_toboolean(lua, 2) : false;
+
+        tic_api_textri_list((tic_mem*)getLuaMachine(lua), pt, triangles, use_map, colors, count);
+
+        free(pt);
+    }
+
+    return 0;
+}
+
 static s32 lua_textri(lua_State* lua)
 {
     s32 top = lua_gettop(lua);
 
+    if(top >= 1 && lua_istable(lua, 1))
+        return lua_textri_list(lua);
+
     if (top >= 12)
     {
         float pt[12];
@@ -303,7 +369,7 @@ static s32 lua_textri(lua_State* lua)
             pt[i] = (float)lua_tonumber(lua, i + 1);
 
         tic_mem* tic = (tic_mem*)getLuaMachine(lua);
-        static u8 colors[TIC_PALETTE_SIZE];
+        u8 colors[TIC_PALETTE_SIZE];
         s32 count = 0;
         bool use_map = false;
 
@@ -312,31 +378,7 @@ static s32 lua_textri(lua_State* lua)
             use_map = lua_toboolean(lua, 13);
         //  check for chroma 
         if(top >= 14)
-        {
-            if(lua_istable(lua, 14))
-            {
-                for(s32 i = 1; i <= TIC_PALETTE_SIZE; i++)
-                {
-                    lua_rawgeti(lua, 14, i);
-                    if(lua_isnumber(lua, -1))
-                    {
-                        colors[i-1] = getLuaNumber(lua, -1);
-                        count++;
-                        lua_pop(lua, 1);
-                    }
-                    else
-                    {
-                        lua_pop(lua, 1);
-                        break;
-                    }
-                }
-            }
-            else 
-            {
-                colors[0] = getLuaNumber(lua, 14);
-                count = 1;
-            }
-        }
+            count = getTextriChroma(lua, 14, colors);
 
         tic_api_textri(tic, pt[0], pt[1],   //  xy 1
                                     pt[2], pt[3],   //  xy 2
@@ -448,7 +490,7 @@ static s32 lua_spr(lua_State* lua)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     if(top >= 1) 
@@ -560,22 +602,88 @@ typedef struct
 {
     lua_State* lua;
     s32 reg;
+    bool failed;
 } RemapData;
 
-static void remapCallback(void* data, s32 x, s32 y, RemapResult* result)
+static void remapCallback(void* data, s32 x, s32 y, s32 count, RemapResult* result)
 {
     RemapData* remap = (RemapData*)data;
     lua_State* lua = remap->lua;
+    s32 top = lua_gettop(lua);
+
+    for(s32 i = 0; i < count; i++, result++)
+    {
+        lua_rawgeti(lua, LUA_REGISTRYINDEX, remap->reg);
+        lua_pushinteger(lua, result->index);
+        lua_pushinteger(lua, x + i);
+        lua_pushinteger(lua, y);
+        lua_pcall(lua, 3, 3, 0);
+
+        result->index = getLuaNumber(lua, -3);
+        result->flip = getLuaNumber(lua, -2);
+        result->rotate = getLuaNumber(lua, -1);
+        lua_settop(lua, top);
+    }
+}
+
+// batched remap: remap(tiles, x, y) is called once per row of visible cells,
+// the tile indices are changed in place and optional flip and rotate tables are returned
+static void remapRowCallback(void* data, s32 x, s32 y, s32 count, RemapResult* result)
+{
+    RemapData* remap = (RemapData*)data;
+    lua_State* lua = remap->lua;
+
+    // the error is reported once, the rest of the map is drawn without remapping
+    if(remap->failed) return;
+
+    s32 top = lua_gettop(lua);
+
+    lua_createtable(lua, count, 0);
+    for(s32 i = 0; i < count; i++)
+    {
+        lua_pushinteger(lua, result[i].index);
+        lua_rawseti(lua, top + 1, i + 1);
+    }
 
     lua_rawgeti(lua, LUA_REGISTRYINDEX, remap->reg);
-    lua_pushinteger(lua, result->index);
+    lua_pushvalue(lua, top + 1);
     lua_pushinteger(lua, x);
     lua_pushinteger(lua, y);
-    lua_pcall(lua, 3, 3, 0);
 
-    result->index = getLuaNumber(lua, -3);
-    result->flip = getLuaNumber(lua, -2);
-    result->rotate = getLuaNumber(lua, -1);
+    if(lua_pcall(lua, 3, 2, 0) == LUA_OK)
+    {
+        bool flip = lua_istable(lua, top + 2);
+        bool rotate = lua_istable(lua, top + 3);
+
+        for(s32 i = 0; i < count; i++)
+        {
+            lua_rawgeti(lua, top + 1, i + 1);
+            result[i].index = getLuaNumber(lua, -1);
+            lua_pop(lua, 1);
+
+            if(flip)
+            {
+                lua_rawgeti(lua, top + 2, i + 1);
+                result[i].flip = getLuaNumber(lua, -1);
+                lua_pop(lua, 1);
+            }
+
+            if(rotate)
+            {
+                lua_rawgeti(lua, top + 3, i + 1);
+                result[i].rotate = getLuaNumber(lua, -1);
+                lua_pop(lua, 1);
+            }
+        }
+    }
+    else
+    {
+        tic_machine* machine = getLuaMachine(lua);
+        machine->data->error(machine->data->data, lua_tostring(lua, -1));
+        remap->failed = true;
+    }
+
+    lua_settop(lua, top);
 }
 
 static s32 lua_map(lua_State* lua)
@@ -587,7 +695,7 @@ static s32 lua_map(lua_State* lua)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     s32 top = lua_gettop(lua);
@@ -641,13 +749,16 @@ static s32 lua_map(lua_State* lua)
                         {
                             if (lua_isfunction(lua, 9))
                             {
+                                bool batch = top >= 10 && lua_toboolean(lua, 10);
+
+                                lua_pushvalue(lua, 9);
                                 s32 remap = luaL_ref(lua, LUA_REGISTRYINDEX);
 
-                                RemapData data = {lua, remap};
+                                RemapData data = {lua, remap, false};
 
                                 tic_mem* tic = (tic_mem*)getLuaMachine(lua);
 
-                                tic_api_map(tic, x, y, w, h, sx, sy, colors, count, scale, remapCallback, &data);
+                                tic_api_map(tic, x, y, w, h, sx, sy, colors, count, scale, batch ? remapRowCallback : remapCallback, &data);
 
                                 luaL_unref(lua, LUA_REGISTRYINDEX, data.reg);
 
@@ -726,7 +837,8 @@ static s32 lua_sfx(lua_State* lua)
         {
             if (index >= 0)
             {
-                tic_sample* effect = tic->ram.sfx.samples.data + index;
+                tic_core_materialize(tic, offsetof(tic_ram, sfx.samples) + index * sizeof(tic_sample), sizeof(tic_sample));
+                const tic_sample* effect = tic->ram.sfx.samples.data + index;
 
                 note = effect->note;
                 octave = effect->octave;
@@ -1506,6 +1618,592 @@ static void evalLua(tic_mem* tic, const char* code) {
     }
 }
 
+// save states keep what's reachable from the globals: nil, booleans, numbers, strings and tables with
+// their metatables are written by value, tables referenced twice are written once; functions can't be
+// recreated, they are written as an id in the running VM and a key of where they're defined, and get
+// their upvalues restored in place. A load finds a function by its id, or takes the function that sits
+// in the same slot of another VM if it was defined at the same place; if neither is there the load
+// fails before anything is changed
+
+enum
+{
+    LuaStateNil,
+    LuaStateFalse,
+    LuaStateTrue,
+    LuaStateInteger,
+    LuaStateNumber,
+    LuaStateString,
+    LuaStateTable,
+    LuaStateFunction,
+    LuaStateRef,
+    LuaStateSkip,
+    LuaStateEnd,
+};
+
+enum {LuaStateMaxDepth = 200};
+
+// functions seen by save states and their ids, both ways, weak so it doesn't keep them alive
+static const char LuaStateFunctions = 0;
+
+// where a function is defined, the same in any VM running the same code
+typedef struct
+{
+    u32 source;
+    s32 first;
+    s32 last;
+} LuaFunctionKey;
+
+typedef struct
+{
+    lua_State* lua;
+    u8* data;
+    s32 size;
+    s32 pos;
+
+    // stack index of the object -> id table
+    s32 seen;
+    s32 objects;
+    s32 depth;
+} LuaStateWriter;
+
+typedef struct
+{
+    lua_State* lua;
+    const u8* data;
+    s32 size;
+    s32 pos;
+
+    // stack indices of the id -> object table and of the tables and functions already restored
+    s32 objects;
+    s32 used;
+    s32 count;
+    s32 depth;
+
+    // walks the state and resolves every function without changing anything
+    bool check;
+} LuaStateReader;
+
+static void pushLuaStateFunctions(lua_State* lua)
+{
+    if(lua_rawgetp(lua, LUA_REGISTRYINDEX, &LuaStateFunctions) == LUA_TNIL)
+    {
+        lua_pop(lua, 1);
+        lua_newtable(lua);
+        lua_newtable(lua);
+        lua_pushstring(lua, "kv");
+        lua_setfield(lua, -2, "__mode");
+        lua_setmetatable(lua, -2);
+        lua_pushvalue(lua, -1);
+        lua_rawsetp(lua, LUA_REGISTRYINDEX, &LuaStateFunctions);
+    }
+}
+
+static u32 getLuaFunctionId(lua_State* lua, s32 index)
+{
+    index = lua_absindex(lua, index);
+    pushLuaStateFunctions(lua);
+
+    lua_pushvalue(lua, index);
+    lua_Integer id;
+
+    if(lua_rawget(lua, -2) == LUA_TNUMBER)
+        id = lua_tointeger(lua, -1);
+    else
+    {
+        // the last id given out is kept at 0
+        lua_rawgeti(lua, -2, 0);
+        id = lua_tointeger(lua, -1) + 1;
+        lua_pop(lua, 1);
+
+        lua_pushinteger(lua, id);
+        lua_rawseti(lua, -3, 0);
+        lua_pushvalue(lua, index);
+        lua_pushinteger(lua, id);
+        lua_rawset(lua, -4);
+        lua_pushvalue(lua, index);
+        lua_rawseti(lua, -3, id);
+    }
+
+    lua_pop(lua, 2);
+    return (u32)id;
+}
+
+static LuaFunctionKey getLuaFunctionKey(lua_State* lua, s32 index)
+{
+    lua_Debug ar;
+    lua_pushvalue(lua, index);
+    lua_getinfo(lua, ">S", &ar);
+
+    LuaFunctionKey key = {2166136261u, ar.linedefined, ar.lastlinedefined};
+
+    for(const char* c = ar.short_src; *c; c++)
+        key.source = (key.source ^ (u8)*c) * 16777619u;
+
+    return key;
+}
+
+static bool isLuaFunctionAt(lua_State* lua, s32 index, const LuaFunctionKey* key)
+{
+    if(lua_type(lua, index) != LUA_TFUNCTION || lua_iscfunction(lua, index))
+        return false;
+
+    LuaFunctionKey other = getLuaFunctionKey(lua, index);
+    return memcmp(&other, key, sizeof other) == 0;
+}
+
+static void writeLuaState(LuaStateWriter* writer, const void* src, s32 size)
+{
+    // only counted once it doesn't fit, the caller gets the size it needs
+    if(writer->data && writer->pos + size <= writer->size)
+        memcpy(writer->data + writer->pos, src, size);
+
+    writer->pos += size;
+}
+
+static void writeLuaStateTag(LuaStateWriter* writer, u8 tag)
+{
+    writeLuaState(writer, &tag, sizeof tag);
+}
+
+static bool writeLuaStateValue(LuaStateWriter* writer, s32 index);
+
+static bool writeLuaStateObject(LuaStateWriter* writer, s32 index)
+{
+    lua_State* lua = writer->lua;
+
+    lua_pushvalue(lua, index);
+    if(lua_rawget(lua, writer->seen) == LUA_TNUMBER)
+    {
+        u32 id = (u32)lua_tointeger(lua, -1);
+        lua_pop(lua, 1);
+
+        writeLuaStateTag(writer, LuaStateRef);
+        writeLuaState(writer, &id, sizeof id);
+        return true;
+    }
+    lua_pop(lua, 1);
+
+    if(++writer->depth > LuaStateMaxDepth || !lua_checkstack(lua, 8))
+        return false;
+
+    lua_pushvalue(lua, index);
+    lua_pushinteger(lua, writer->objects++);
+    lua_rawset(lua, writer->seen);
+
+    if(lua_type(lua, index) == LUA_TTABLE)
+    {
+        writeLuaStateTag(writer, LuaStateTable);
+
+        lua_pushnil(lua);
+        while(lua_next(lua, index))
+        {
+            s32 type = lua_type(lua, -2);
+
+            // keys are only matched by value
+            if(type == LUA_TSTRING || type == LUA_TNUMBER || type == LUA_TBOOLEAN)
+                if(!writeLuaStateValue(writer, -2) || !writeLuaStateValue(writer, -1))
+                    return false;
+
+            lua_pop(lua, 1);
+        }
+
+        writeLuaStateTag(writer, LuaStateEnd);
+
+        if(lua_getmetatable(lua, index))
+        {
+            if(!writeLuaStateValue(writer, -1))
+                return false;
+
+            lua_pop(lua, 1);
+        }
+        else writeLuaStateTag(writer, LuaStateNil);
+    }
+    else
+    {
+        u32 id = getLuaFunctionId(lua, index);
+        LuaFunctionKey key = getLuaFunctionKey(lua, index);
+        u32 count = 0;
+
+        while(lua_getupvalue(lua, index, count + 1))
+        {
+            lua_pop(lua, 1);
+            count++;
+        }
+
+        writeLuaStateTag(writer, LuaStateFunction);
+        writeLuaState(writer, &id, sizeof id);
+        writeLuaState(writer, &key, sizeof key);
+        writeLuaState(writer, &count, sizeof count);
+
+        for(u32 i = 1; i <= count; i++)
+        {
+            lua_getupvalue(lua, index, i);
+
+            if(!writeLuaStateValue(writer, -1))
+                return false;
+
+            lua_pop(lua, 1);
+        }
+    }
+
+    writer->depth--;
+    return true;
+}
+
+static bool writeLuaStateValue(LuaStateWriter* writer, s32 index)
+{
+    lua_State* lua = writer->lua;
+    index = lua_absindex(lua, index);
+
+    switch(lua_type(lua, index))
+    {
+    case LUA_TNIL:
+        writeLuaStateTag(writer, LuaStateNil);
+        break;
+    case LUA_TBOOLEAN:
+        writeLuaStateTag(writer, lua_toboolean(lua, index) ? LuaStateTrue : LuaStateFalse);
+        break;
+    case LUA_TNUMBER:
+        if(lua_isinteger(lua, index))
+        {
+            lua_Integer value = lua_tointeger(lua, index);
+            writeLuaStateTag(writer, LuaStateInteger);
+            writeLuaState(writer, &value, sizeof value);
+        }
+        else
+        {
+            lua_Number value = lua_tonumber(lua, index);
+            writeLuaStateTag(writer, LuaStateNumber);
+            writeLuaState(writer, &value, sizeof value);
+        }
+        break;
+    case LUA_TSTRING:
+        {
+            size_t len;
+            const char* str = lua_tolstring(lua, index, &len);
+            u32 size = (u32)len;
+            writeLuaStateTag(writer, LuaStateString);
+            writeLuaState(writer, &size, sizeof size);
+            writeLuaState(writer, str, size);
+        }
+        break;
+    case LUA_TTABLE:
+        return writeLuaStateObject(writer, index);
+    case LUA_TFUNCTION:
+        if(!lua_iscfunction(lua, index))
+            return writeLuaStateObject(writer, index);
+        // fallthrough
+    default:
+        // userdata, threads and C functions stay as they are
+        writeLuaStateTag(writer, LuaStateSkip);
+    }
+
+    return true;
+}
+
+static bool readLuaState(LuaStateReader* reader, void* dst, s32 size)
+{
+    if(size < 0 || reader->pos + size > reader->size)
+        return false;
+
+    memcpy(dst, reader->data + reader->pos, size);
+    reader->pos += size;
+    return true;
+}
+
+// pushes the value read, the value at candidate is updated in place when it's a table or a function;
+// returns -1 on broken data, 0 if the slot keeps its value and nothing was pushed
+static s32 readLuaStateValue(LuaStateReader* reader, s32 candidate);
+
+static s32 readLuaStateTable(LuaStateReader* reader, s32 candidate)
+{
+    lua_State* lua = reader->lua;
+
+    if(++reader->depth > LuaStateMaxDepth || !lua_checkstack(lua, 8))
+        return -1;
+
+    // a table already taken by another object of the state can't be reused
+    bool reuse = false;
+    if(candidate && lua_type(lua, candidate) == LUA_TTABLE)
+    {
+        lua_pushvalue(lua, candidate);
+        reuse = lua_rawget(lua, reader->used) == LUA_TNIL;
+        lua_pop(lua, 1);
+    }
+
+    if(reuse)
+        lua_pushvalue(lua, candidate);
+    else lua_newtable(lua);
+
+    s32 table = lua_gettop(lua);
+
+    lua_pushvalue(lua, table);
+    lua_pushboolean(lua, true);
+    lua_rawset(lua, reader->used);
+
+    lua_pushvalue(lua, table);
+    lua_rawseti(lua, reader->objects, reader->count++);
+
+    // keys of the state, the data under any other key is removed afterwards
+    lua_newtable(lua);
+    s32 keys = lua_gettop(lua);
+
+    for(;;)
+    {
+        u8 tag;
+        if(!readLuaState(reader, &tag, sizeof tag))
+            return -1;
+
+        if(tag == LuaStateEnd)
+            break;
+
+        reader->pos--;
+
+        if(readLuaStateValue(reader, 0) <= 0)
+            return -1;
+
+        lua_pushvalue(lua, -1);
+        lua_pushboolean(lua, true);
+        lua_rawset(lua, keys);
+
+        lua_pushvalue(lua, -1);
+        lua_rawget(lua, table);
+
+        s32 result = readLuaStateValue(reader, lua_gettop(lua));
+        if(result < 0)
+            return -1;
+
+        if(result && !reader->check)
+        {
+            lua_remove(lua, -2);
+            lua_rawset(lua, table);
+        }
+        else lua_settop(lua, keys);
+    }
+
+    lua_newtable(lua);
+    s32 stale = lua_gettop(lua);
+    lua_Integer count = 0;
+
+    lua_pushnil(lua);
+    while(!reader->check && lua_next(lua, table))
+    {
+        lua_pop(lua, 1);
+        s32 type = lua_type(lua, -1);
+
+        // the same keys the writer keeps, whatever the value under them
+        if(type == LUA_TBOOLEAN || type == LUA_TNUMBER || type == LUA_TSTRING)
+        {
+            lua_pushvalue(lua, -1);
+            if(lua_rawget(lua, keys) == LUA_TNIL)
+            {
+                lua_pushvalue(lua, -2);
+                lua_rawseti(lua, stale, ++count);
+            }
+            lua_pop(lua, 1);
+        }
+    }
+
+    for(lua_Integer i = 1; i <= count; i++)
+    {
+        lua_rawgeti(lua, stale, i);
+        lua_pushnil(lua);
+        lua_rawset(lua, table);
+    }
+
+    lua_settop(lua, table);
+
+    if(lua_getmetatable(lua, table) == 0)
+        lua_pushnil(lua);
+
+    s32 result = readLuaStateValue(reader, lua_gettop(lua));
+    if(result < 0)
+        return -1;
+
+    if(result && !reader->check)
+    {
+        if(lua_type(lua, -1) == LUA_TTABLE || lua_isnil(lua, -1))
+            lua_setmetatable(lua, table);
+        else lua_pop(lua, 1);
+    }
+
+    lua_settop(lua, table);
+    reader->depth--;
+    return 1;
+}
+
+static s32 readLuaStateFunction(LuaStateReader* reader, s32 candidate)
+{
+    lua_State* lua = reader->lua;
+    LuaFunctionKey key;
+    u32 id, count;
+
+    if(++reader->depth > LuaStateMaxDepth || !lua_checkstack(lua, 8) || !readLuaState(reader, &id, sizeof id)
+        || !readLuaState(reader, &key, sizeof key) || !readLuaState(reader, &count, sizeof count))
+        return -1;
+
+    pushLuaStateFunctions(lua);
+    lua_rawgeti(lua, -1, id);
+    lua_remove(lua, -2);
+
+    // ids only hold in the VM that saved the state, another VM has to define it in the same slot
+    if(!isLuaFunctionAt(lua, -1, &key))
+    {
+        lua_pop(lua, 1);
+
+        if(!candidate || !isLuaFunctionAt(lua, candidate, &key))
+            return -1;
+
+        lua_pushvalue(lua, candidate);
+    }
+
+    s32 func = lua_gettop(lua);
+
+    // every function of the state is read once, one the live VM gave to another can't be shared
+    lua_pushvalue(lua, func);
+    if(lua_rawget(lua, reader->used) != LUA_TNIL)
+        return -1;
+
+    lua_pop(lua, 1);
+    lua_pushvalue(lua, func);
+    lua_pushboolean(lua, true);
+    lua_rawset(lua, reader->used);
+
+    lua_pushvalue(lua, func);
+    lua_rawseti(lua, reader->objects, reader->count++);
+
+    for(u32 i = 1; i <= count; i++)
+    {
+        if(!lua_getupvalue(lua, func, i))
+            lua_pushnil(lua);
+
+        s32 result = readLuaStateValue(reader, lua_gettop(lua));
+        if(result < 0)
+            return -1;
+
+        if(result && (reader->check || !lua_setupvalue(lua, func, i)))
+            lua_pop(lua, 1);
+
+        lua_pop(lua, 1);
+    }
+
+    reader->depth--;
+    return 1;
+}
+
+static s32 readLuaStateValue(LuaStateReader* reader, s32 candidate)
+{
+    lua_State* lua = reader->lua;
+    u8 tag;
+
+    if(!readLuaState(reader, &tag, sizeof tag))
+        return -1;
+
+    switch(tag)
+    {
+    case LuaStateNil:
+        lua_pushnil(lua);
+        break;
+    case LuaStateFalse:
+    case LuaStateTrue:
+        lua_pushboolean(lua, tag == LuaStateTrue);
+        break;
+    case LuaStateInteger:
+        {
+            lua_Integer value;
+            if(!readLuaState(reader, &value, sizeof value))
+                return -1;
+            lua_pushinteger(lua, value);
+        }
+        break;
+    case LuaStateNumber:
+        {
+            lua_Number value;
+            if(!readLuaState(reader, &value, sizeof value))
+                return -1;
+            lua_pushnumber(lua, value);
+        }
+        break;
+    case LuaStateString:
+        {
+            u32 size;
+            if(!readLuaState(reader, &size, sizeof size) || size > (u32)(reader->size - reader->pos))
+                return -1;
+            lua_pushlstring(lua, (const char*)reader->data + reader->pos, size);
+            reader->pos += size;
+        }
+        break;
+    case LuaStateRef:
+        {
+            u32 id;
+            if(!readLuaState(reader, &id, sizeof id) || id >= (u32)reader->count)
+                return -1;
+
+            if(lua_rawgeti(lua, reader->objects, id) == LUA_TNIL)
+            {
+                lua_pop(lua, 1);
+                return 0;
+            }
+        }
+        break;
+    case LuaStateTable:
+        return readLuaStateTable(reader, candidate);
+    case LuaStateFunction:
+        return readLuaStateFunction(reader, candidate);
+    case LuaStateSkip:
+        return 0;
+    default:
+        return -1;
+    }
+
+    return 1;
+}
+
+static s32 saveLua(tic_mem* tic, void* buffer, s32 size)
+{
+    tic_machine* machine = (tic_machine*)tic;
+    lua_State* lua = machine->lua;
+
+    if(!lua) return 0;
+
+    lua_settop(lua, 0);
+    lua_newtable(lua);
+    lua_pushglobaltable(lua);
+
+    LuaStateWriter writer = {.lua = lua, .data = buffer, .size = size, .seen = 1};
+    bool done = writeLuaStateValue(&writer, 2);
+
+    lua_settop(lua, 0);
+
+    // data nested too deep to save, the caller decides how to tell
+    return done ? writer.pos : 0;
+}
+
+static bool loadLua(tic_mem* tic, const void* buffer, s32 size)
+{
+    tic_machine* machine = (tic_machine*)tic;
+    lua_State* lua = machine->lua;
+
+    if(!lua) return false;
+
+    bool done = true;
+
+    // a dry run first, so a state that can't be restored leaves the VM as it is
+    for(s32 pass = 0; pass < 2 && done; pass++)
+    {
+        lua_settop(lua, 0);
+        lua_newtable(lua);
+        lua_newtable(lua);
+        lua_pushglobaltable(lua);
+
+        LuaStateReader reader = {.lua = lua, .data = buffer, .size = size, .objects = 1, .used = 2, .check = pass == 0};
+        done = readLuaStateValue(&reader, 3) > 0 && reader.pos == size;
+    }
+
+    lua_settop(lua, 0);
+    return done;
+}
+
 static const tic_script_config LuaSyntaxConfig = 
 {
     .init               = initLua,
@@ -1516,6 +2214,8 @@ static const tic_script_config LuaSyntaxConfig =
 
     .getOutline         = getLuaOutline,
     .eval               = evalLua,
+    .save               = saveLua,
+    .load               = loadLua,
 
     .blockCommentStart  = "--[[",
     .blockCommentEnd    = "]]",
@@ -1681,6 +2381,8 @@ static const tic_script_config MoonSyntaxConfig =
 
     .getOutline         = getMoonOutline,
     .eval               = NULL,
+    .save               = saveLua,
+    .load               = loadLua,
 
     .blockCommentStart  = NULL,
     .blockCommentEnd    = NULL,
@@ -1855,6 +2557,8 @@ static const tic_script_config FennelSyntaxConfig =
 
     .getOutline         = getFennelOutline,
     .eval               = evalFennel,
+    .save               = saveLua,
+    .load               = loadLua,
 
     .blockCommentStart  = NULL,
     .blockCommentEnd    = NULL,
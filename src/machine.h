@@ -24,8 +24,14 @@
 
 #include "ticapi.h"
 #include "tools.h"
+#include "tilesheet.h"
+#include "jobs.h"
 #include "blip_buf.h"
 
+#define TIC_OVR_LOOKUP_BITS 6
+#define TIC_SYNC_SECTIONS 7
+#define TIC_SOUND_QUEUE 32
+
 typedef struct
 {
     s32 time;       /* clock time of next delta */
@@ -33,6 +39,15 @@ typedef struct
     s32 amp;        /* current amplitude in delta buffer */
 }tic_sound_register_data;
 
+// sound registers of one frame queued for the audio thread, played for its samples
+typedef struct
+{
+    tic_sound_register registers[TIC_SOUND_CHANNELS];
+    bool noise[TIC_SOUND_CHANNELS];
+    tic_stereo_volume stereo;
+    s32 samples;
+} tic_sound_frame;
+
 typedef struct
 {
     s32 tick;
@@ -92,6 +107,14 @@ typedef struct
     s32 b;
 } tic_clip_data;
 
+typedef struct
+{
+    u32 palette;
+    u8 border;
+    s8 x;
+    s8 y;
+} tic_blit_state;
+
 typedef struct
 {
     bool active;
@@ -146,11 +169,19 @@ typedef struct
     {
         tic_overline callback;
         u32 palette[TIC_PALETTE_SIZE];
+
+        // reverse palette lookup, open addressing by color hash
+        struct
+        {
+            u32 color;
+            s8 index;
+        } lookup[1 << TIC_OVR_LOOKUP_BITS];
     } ovr;
 
     void (*setpix)(tic_mem* memory, s32 x, s32 y, u8 color);
     u8 (*getpix)(tic_mem* memory, s32 x, s32 y);
     void (*drawhline)(tic_mem* memory, s32 xl, s32 xr, s32 y, u8 color);
+    void (*drawspan)(tic_mem* memory, const u8* colors, s32 x, s32 y, s32 width);
 
     u32 synced;
 
@@ -169,10 +200,21 @@ typedef struct
 
 #if defined(TIC_BUILD_WITH_JS)
         struct duk_hthread* js;
+        u64 jsTimeoutChecks;
 #endif
 
 #if defined(TIC_BUILD_WITH_WREN)
         struct WrenVM* wren;
+
+        struct
+        {
+            bool loaded;
+            struct WrenHandle* game_class;
+            struct WrenHandle* new_handle;
+            struct WrenHandle* update_handle;
+            struct WrenHandle* scanline_handle;
+            struct WrenHandle* overline_handle;
+        } wrenHandles;
 #endif  
 
 #if defined(TIC_BUILD_WITH_SQUIRREL)
@@ -189,6 +231,125 @@ typedef struct
     
     s32 samplerate;
 
+    // noise or wave for every sfx waveform and every sound register, dropped when its waveform is written in ram
+    struct
+    {
+        bool valid[WAVES_COUNT];
+        bool noise[WAVES_COUNT];
+
+        struct
+        {
+            bool valid[TIC_SOUND_CHANNELS];
+            bool noise[TIC_SOUND_CHANNELS];
+        } registers;
+    } waves;
+
+    // synthesis is skipped while muted, music and sfx still advance
+    bool muted;
+
+    // synthesis on the thread calling tic_core_synth, tick end only queues the registers of the frame
+    struct
+    {
+        s32 limit;
+        s32 rest;
+        s32 rate;
+
+        // written at head by the ticks, read at tail by the audio thread
+        tic_sound_frame frames[TIC_SOUND_QUEUE];
+        volatile s32 head;
+        volatile s32 tail;
+        volatile s32 underruns;
+
+        // owned by the audio thread, remain is also read by tic_core_audio_queued
+        tic_sound_frame current;
+        volatile s32 remain;
+        s32 starved;
+
+        struct
+        {
+            tic_sound_register_data left[TIC_SOUND_CHANNELS];
+            tic_sound_register_data right[TIC_SOUND_CHANNELS];
+        } registers;
+
+        struct
+        {
+            blip_buffer_t* left;
+            blip_buffer_t* right;
+        } blip;
+    } audio;
+
+    // a cart image shared with other instances is never written, sync to cart copies the banks it touches
+    struct
+    {
+        bool shared;
+        tic_bank* banks[TIC_BANKS];
+        // banks sync to cart wrote since the cart was loaded, a state keeps sections mapped to them by value
+        u8 written;
+    } cart;
+
+    // sync points sections at a cart bank instead of copying them, ram gets them on the first direct access
+    struct
+    {
+        bool enabled;
+        // bank index plus one, 0 while ram holds the section
+        u8 banks[TIC_SYNC_SECTIONS];
+    } mapping;
+
+    tic_tilecache tilecache;
+
+    // system font glyph bounds for proportional text, rebuilt after ram.font changes
+    struct
+    {
+        bool valid;
+        u8 start[TIC_FONT_CHARS];
+        u8 end[TIC_FONT_CHARS];
+    } glyphs;
+
+    struct
+    {
+        tic_palette src;
+        tic80_pixel_color_format format;
+        u32 colors[TIC_PALETTE_SIZE];
+        u32 pairs[1 << BITS_IN_BYTE][2];
+        // bumped every time colors are rebuilt
+        u32 version;
+        bool valid;
+        bool paired;
+    } palette;
+
+    // screen rows to convert on the next blit
+    struct
+    {
+        bool rows[TIC80_HEIGHT];
+        bool ovr[TIC80_HEIGHT];
+
+        // what every output row and the top/bottom borders were converted with
+        tic_blit_state state[TIC80_HEIGHT];
+        tic_blit_state top;
+        tic_blit_state bottom;
+    } blit;
+
+    struct
+    {
+        bool enabled;
+        bool dirty;
+        u8 pixels[TIC80_WIDTH * TIC80_HEIGHT];
+    } shadow;
+
+    // draw calls recorded during the tick and replayed by screen bands
+    struct
+    {
+        tic_jobs* jobs;
+        bool active;
+        // one bit per blit segment the recorded tile calls use
+        u16 segments;
+        s32 bands;
+
+        u8* data;
+        s32 size;
+        s32 capacity;
+    } deferred;
+
     tic_tick_data* data;
 
     tic_machine_state_data state;
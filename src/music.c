@@ -1433,7 +1433,7 @@ static void drawTumbler(Music* music, s32 x, s32 y, s32 index)
     tic_api_rect(tic, x, y, Width, Height, tic_color_0);
 
     u8 color = tic_color_0;
-    tiles2ram(&tic->ram, &getConfig()->cart->bank0.tiles);
+    tiles2ram(tic, &getConfig()->cart->bank0.tiles);
     tic_api_spr(tic, music->tracker.on[index] ? On : Off, x, y, 1, 1, &color, 1, 1, tic_no_flip, tic_no_rotate);
 }
 
@@ -63,27 +63,35 @@ int main(int argc, char **argv)
 				
 				SDL_AudioDeviceID audioDevice = 0;
 				SDL_AudioSpec audioSpec;
-				SDL_AudioCVT cvt;
+				float* audioFloats = NULL;
 				bool audioStarted = false;
 
 				{
 					SDL_AudioSpec want = 
 					{
 						.freq = TIC80_SAMPLERATE,
-						.format = AUDIO_S16,
+						.format = AUDIO_S16SYS,
 						.channels = 2,
 						.userdata = NULL,
 					};
 
-					audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, &audioSpec, SDL_AUDIO_ALLOW_ANY_CHANGE);
+					// the sound is made at the device rate, s16 is queued as is and f32 is converted while it's queued
+					audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, &audioSpec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_FORMAT_CHANGE);
 
-					SDL_BuildAudioCVT(&cvt, want.format, want.channels, audioSpec.freq, audioSpec.format, audioSpec.channels, audioSpec.freq);
+					if (audioDevice && audioSpec.format != AUDIO_S16SYS && audioSpec.format != AUDIO_F32SYS)
+					{
+						SDL_CloseAudioDevice(audioDevice);
+						audioDevice = SDL_OpenAudioDevice(NULL, 0, &want, &audioSpec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+					}
 
-					if (cvt.needed)
+					if (audioDevice)
 					{
-						cvt.len = audioSpec.freq * sizeof(s16) / TIC80_FRAMERATE;
-						cvt.buf = SDL_malloc(cvt.len * cvt.len_mult);
+						// frames are a sample longer when the rate isn't a multiple of the framerate
+						if (audioSpec.format == AUDIO_F32SYS)
+							audioFloats = SDL_malloc((audioSpec.freq / TIC80_FRAMERATE + 1) * audioSpec.channels * sizeof(float));
 					}
+					// the spec is never filled in without a device, the sound is made and dropped
+					else audioSpec.freq = TIC80_SAMPLERATE;
 				}
 
 				tic80_input input;
@@ -154,11 +162,12 @@ int main(int argc, char **argv)
 							SDL_PauseAudioDevice(audioDevice, 0);
 							s32 size = tic->sound.count * sizeof(tic->sound.samples[0]);
 
-							if (cvt.needed)
+							if (audioFloats)
 							{
-								SDL_memcpy(cvt.buf, tic->sound.samples, size);
-								SDL_ConvertAudio(&cvt);
-								SDL_QueueAudio(audioDevice, cvt.buf, cvt.len_cvt);
+								for (s32 i = 0; i < tic->sound.count; i++)
+									audioFloats[i] = tic->sound.samples[i] / 32768.0f;
+
+								SDL_QueueAudio(audioDevice, audioFloats, tic->sound.count * sizeof(float));
 							}
 							else SDL_QueueAudio(audioDevice, tic->sound.samples, size);
 						}
@@ -193,6 +202,7 @@ int main(int argc, char **argv)
 				SDL_DestroyRenderer(renderer);
 				SDL_DestroyWindow(window);
 				SDL_CloseAudioDevice(audioDevice);
+				SDL_free(audioFloats);
 			}
 
 			SDL_free(cart);
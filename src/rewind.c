@@ -0,0 +1,358 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "rewind.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// every frame keeps the xor of its state with the next one, the latest state is kept as it is,
+// so stepping back is xoring the last delta into it; deltas are packed as runs of
+// <equal bytes to skip, varint> <changed bytes, varint> <xor of the changed bytes>
+
+typedef struct
+{
+    s32 offset;
+    s32 bytes;
+    // size of the state the delta gives back
+    s32 size;
+} Delta;
+
+struct tic_rewind
+{
+    // ring of packed deltas
+    u8* data;
+    s32 budget;
+    s32 head;
+    s32 used;
+
+    // deque of the deltas in the ring, oldest first
+    Delta* deltas;
+    s32 first;
+    s32 count;
+    s32 capacity;
+
+    // latest state, zeroed past its size up to the capacity
+    u8* state;
+    u8* next;
+    s32 size;
+    s32 stateCapacity;
+
+    u8* packed;
+};
+
+// short equal spans are cheaper to keep inside a run of changes
+enum {MinSkip = 8};
+
+tic_rewind* tic_rewind_create(s32 budget)
+{
+    tic_rewind* rewind = calloc(1, sizeof(tic_rewind));
+
+    if(rewind && !(rewind->data = malloc(budget)))
+    {
+        free(rewind);
+        return NULL;
+    }
+
+    if(rewind)
+        rewind->budget = budget;
+
+    return rewind;
+}
+
+void tic_rewind_close(tic_rewind* rewind)
+{
+    if(!rewind) return;
+
+    free(rewind->data);
+    free(rewind->deltas);
+    free(rewind->state);
+    free(rewind->next);
+    free(rewind->packed);
+    free(rewind);
+}
+
+void tic_rewind_clear(tic_rewind* rewind)
+{
+    rewind->head = rewind->used = 0;
+    rewind->first = rewind->count = 0;
+
+    if(rewind->state)
+        memset(rewind->state, 0, rewind->stateCapacity);
+
+    rewind->size = 0;
+}
+
+static inline Delta* getDelta(tic_rewind* rewind, s32 index)
+{
+    return &rewind->deltas[(rewind->first + index) % rewind->capacity];
+}
+
+static void dropOldest(tic_rewind* rewind)
+{
+    rewind->used -= getDelta(rewind, 0)->bytes;
+    rewind->first = (rewind->first + 1) % rewind->capacity;
+
+    if(--rewind->count == 0)
+        rewind->head = 0;
+}
+
+static bool growDeltas(tic_rewind* rewind)
+{
+    if(rewind->count < rewind->capacity)
+        return true;
+
+    s32 capacity = rewind->capacity ? rewind->capacity * 2 : 256;
+    Delta* deltas = malloc(sizeof(Delta) * capacity);
+
+    if(!deltas)
+        return false;
+
+    for(s32 i = 0; i < rewind->count; i++)
+        deltas[i] = *getDelta(rewind, i);
+
+    free(rewind->deltas);
+    rewind->deltas = deltas;
+    rewind->first = 0;
+    rewind->capacity = capacity;
+
+    return true;
+}
+
+static bool growState(tic_rewind* rewind, s32 size)
+{
+    if(size <= rewind->stateCapacity)
+        return true;
+
+    // the packed delta of a whole state never exceeds this
+    s32 packed = size + (size / MinSkip + 2) * 10;
+    u8* state = realloc(rewind->state, size);
+    if(state) rewind->state = state;
+    u8* next = realloc(rewind->next, size);
+    if(next) rewind->next = next;
+    u8* buffer = realloc(rewind->packed, packed);
+    if(buffer) rewind->packed = buffer;
+
+    if(!state || !next || !buffer)
+        return false;
+
+    memset(rewind->state + rewind->stateCapacity, 0, size - rewind->stateCapacity);
+    rewind->stateCapacity = size;
+
+    return true;
+}
+
+static inline u8* writeVarint(u8* ptr, u32 value)
+{
+    for(; value >= 0x80; value >>= 7)
+        *ptr++ = (u8)(value | 0x80);
+
+    *ptr++ = (u8)value;
+    return ptr;
+}
+
+static inline const u8* readVarint(const u8* ptr, u32* value)
+{
+    *value = 0;
+
+    for(s32 shift = 0;; shift += 7)
+    {
+        u8 byte = *ptr++;
+        *value |= (u32)(byte & 0x7f) << shift;
+
+        if(!(byte & 0x80))
+            return ptr;
+    }
+}
+
+// first index from pos where the buffers differ, compared by words
+static s32 findChange(const u8* a, const u8* b, s32 pos, s32 size)
+{
+    for(; pos + (s32)sizeof(u64) <= size; pos += sizeof(u64))
+    {
+        u64 wa, wb;
+        memcpy(&wa, a + pos, sizeof wa);
+        memcpy(&wb, b + pos, sizeof wb);
+
+        if(wa != wb)
+            break;
+    }
+
+    while(pos < size && a[pos] == b[pos])
+        pos++;
+
+    return pos;
+}
+
+static s32 packDelta(const u8* a, const u8* b, s32 size, u8* out)
+{
+    u8* ptr = out;
+
+    for(s32 pos = findChange(a, b, 0, size); pos < size;)
+    {
+        // the run of changes ends at the first equal span long enough to skip
+        s32 end = pos;
+        for(;;)
+        {
+            while(end < size && a[end] != b[end])
+                end++;
+
+            s32 next = findChange(a, b, end, size);
+            if(next - end >= MinSkip || next == size)
+                break;
+
+            end = next;
+        }
+
+        ptr = writeVarint(ptr, end - pos);
+        for(s32 i = pos; i < end; i++)
+            *ptr++ = a[i] ^ b[i];
+
+        s32 next = findChange(a, b, end, size);
+        if(next < size)
+            ptr = writeVarint(ptr, next - end);
+
+        pos = next;
+    }
+
+    return (s32)(ptr - out);
+}
+
+static void unpackDelta(u8* state, const u8* ptr, s32 bytes)
+{
+    const u8* end = ptr + bytes;
+    s32 pos = 0;
+
+    while(ptr < end)
+    {
+        u32 count;
+        ptr = readVarint(ptr, &count);
+
+        for(u32 i = 0; i < count; i++)
+            state[pos++] ^= *ptr++;
+
+        if(ptr < end)
+        {
+            u32 skip;
+            ptr = readVarint(ptr, &skip);
+            pos += skip;
+        }
+    }
+}
+
+void tic_rewind_push(tic_rewind* rewind, const void* state, s32 size)
+{
+    s32 total = size > rewind->size ? size : rewind->size;
+
+    if(!growState(rewind, size) || !growDeltas(rewind))
+    {
+        tic_rewind_clear(rewind);
+        return;
+    }
+
+    memcpy(rewind->next, state, size);
+    memset(rewind->next + size, 0, rewind->stateCapacity - size);
+
+    // the stream starts with a skip, so it begins at the first change
+    s32 first = findChange(rewind->state, rewind->next, 0, total);
+    u8* ptr = writeVarint(rewind->packed, first);
+    s32 bytes = (s32)(ptr - rewind->packed) + packDelta(rewind->state + first, rewind->next + first, total - first, ptr);
+
+    u8* swap = rewind->state;
+    rewind->state = rewind->next;
+    rewind->next = swap;
+
+    s32 previous = rewind->size;
+    rewind->size = size;
+
+    // the first frame has nothing to go back to
+    if(!previous)
+        return;
+
+    if(bytes > rewind->budget)
+    {
+        while(rewind->count)
+            dropOldest(rewind);
+
+        return;
+    }
+
+    s32 offset = rewind->head;
+
+    // the ring tail is too short, the deltas left there are the oldest ones
+    if(offset + bytes > rewind->budget)
+    {
+        while(rewind->count && getDelta(rewind, 0)->offset >= offset)
+            dropOldest(rewind);
+
+        offset = 0;
+    }
+
+    while(rewind->count)
+    {
+        const Delta* oldest = getDelta(rewind, 0);
+
+        if(oldest->offset >= offset + bytes || oldest->offset + oldest->bytes <= offset)
+            break;
+
+        dropOldest(rewind);
+    }
+
+    memcpy(rewind->data + offset, rewind->packed, bytes);
+
+    *getDelta(rewind, rewind->count++) = (Delta){offset, bytes, previous};
+    rewind->head = offset + bytes;
+    rewind->used += bytes;
+}
+
+const void* tic_rewind_pop(tic_rewind* rewind, s32* size)
+{
+    if(!rewind->count)
+        return NULL;
+
+    const Delta* delta = getDelta(rewind, rewind->count - 1);
+
+    const u8* ptr = rewind->data + delta->offset;
+    u32 skip;
+    ptr = readVarint(ptr, &skip);
+
+    unpackDelta(rewind->state + skip, ptr, delta->bytes - (s32)(ptr - (rewind->data + delta->offset)));
+
+    rewind->size = delta->size;
+    rewind->head = delta->offset;
+    rewind->used -= delta->bytes;
+    rewind->count--;
+
+    *size = rewind->size;
+    return rewind->state;
+}
+
+s32 tic_rewind_frames(const tic_rewind* rewind)
+{
+    return rewind->count;
+}
+
+s32 tic_rewind_rate(const tic_rewind* rewind, s32 fps)
+{
+    return rewind->count ? (s32)((s64)rewind->used * fps / rewind->count) : 0;
+}
@@ -0,0 +1,41 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "tic80_types.h"
+
+typedef struct tic_rewind tic_rewind;
+
+// history of saved states in a fixed memory budget, the oldest frames are dropped to stay in it
+tic_rewind* tic_rewind_create(s32 budget);
+void tic_rewind_close(tic_rewind* rewind);
+void tic_rewind_clear(tic_rewind* rewind);
+
+// records the state of a new frame
+void tic_rewind_push(tic_rewind* rewind, const void* state, s32 size);
+// steps back one frame and returns the state to load, NULL when there's no history left
+const void* tic_rewind_pop(tic_rewind* rewind, s32* size);
+
+s32 tic_rewind_frames(const tic_rewind* rewind);
+// history bytes kept for one second of frames at the given framerate
+s32 tic_rewind_rate(const tic_rewind* rewind, s32 fps);
@@ -81,7 +81,7 @@ static void initPMemName(Run* run)
 {
     tic_mem* tic = run->tic;
 
-    const void* data = &tic->cart.bank0;
+    const void* data = &tic->cart->bank0;
     s32 dataSize = sizeof(tic_bank);
 
     if(strlen(tic->saveid))
@@ -96,6 +96,79 @@ static void initPMemName(Run* run)
     strcat(run->saveid, md5);
 }
 
+#define REWIND_BUDGET (32 * 1024 * 1024)
+
+static void freeRewind(Run* run)
+{
+    tic_rewind_close(run->rewind.history);
+    free(run->rewind.state);
+
+    run->rewind.history = NULL;
+    run->rewind.state = NULL;
+    run->rewind.size = 0;
+}
+
+static void saveRewindFrame(Run* run)
+{
+    tic_mem* tic = run->tic;
+    u64 start = getSystem()->getPerformanceCounter();
+
+    s32 size = tic_core_save_state(tic, run->rewind.state, run->rewind.size);
+
+    if(size > run->rewind.size)
+    {
+        void* state = realloc(run->rewind.state, size);
+
+        if(state)
+        {
+            run->rewind.state = state;
+            run->rewind.size = size;
+            size = tic_core_save_state(tic, state, size);
+        }
+        else size = 0;
+    }
+
+    // the script went out of what a state can hold, it plays on without rewind
+    if(!size)
+    {
+        freeRewind(run);
+        return;
+    }
+
+    tic_rewind_push(run->rewind.history, run->rewind.state, size);
+
+    run->rewind.cost += getSystem()->getPerformanceCounter() - start;
+    run->rewind.frames++;
+}
+
+static void rewindFrame(Run* run)
+{
+    if(!run->rewind.active)
+    {
+        char info[TICNAME_MAX];
+        s32 frames = tic_rewind_frames(run->rewind.history);
+        s32 micros = run->rewind.frames 
+            ? (s32)(run->rewind.cost / run->rewind.frames * 1000000 / getSystem()->getPerformanceFrequency()) : 0;
+
+        snprintf(info, sizeof info, "rewind %i.%is, %iKB per second, %ius per frame", frames / TIC80_FRAMERATE, frames % TIC80_FRAMERATE * 10 / TIC80_FRAMERATE,
+            tic_rewind_rate(run->rewind.history, TIC80_FRAMERATE) / 1024, micros);
+
+        run->console->trace(run->console, info, tic_color_14);
+        run->rewind.active = true;
+    }
+
+    s32 size;
+    const void* state = tic_rewind_pop(run->rewind.history, &size);
+
+    // the machine stays on the frame it's at and plays on without rewind
+    if(state && !tic_core_load_state(run->tic, &run->tickData, state, size))
+    {
+        freeRewind(run);
+        run->rewind.active = false;
+        run->console->error(run->console, "rewind is off, a saved frame couldn't be restored");
+    }
+}
+
 static void tick(Run* run)
 {
     if (getStudioMode() != TIC_RUN_MODE)
@@ -103,7 +176,17 @@ static void tick(Run* run)
 
     tic_mem* tic = run->tic;
 
-    tic_core_tick(tic, &run->tickData);
+    if(run->rewind.history && tic_api_key(tic, tic_key_f10))
+        rewindFrame(run);
+    else
+    {
+        run->rewind.active = false;
+
+        tic_core_tick(tic, &run->tickData);
+
+        if(run->rewind.history && getStudioMode() == TIC_RUN_MODE)
+            saveRewindFrame(run);
+    }
 
     enum {Size = sizeof(tic_persistent)};
 
@@ -117,6 +200,16 @@ static void tick(Run* run)
         setStudioMode(TIC_CONSOLE_MODE);
 }
 
+static u64 getCounter(void* data)
+{
+    return getSystem()->getPerformanceCounter();
+}
+
+static u64 getFreq(void* data)
+{
+    return getSystem()->getPerformanceFrequency();
+}
+
 static bool forceExit(void* data)
 {
     getSystem()->poll();
@@ -128,6 +221,8 @@ static bool forceExit(void* data)
 
 void initRun(Run* run, Console* console, tic_mem* tic)
 {
+    freeRewind(run);
+
     *run = (Run)
     {
         .tic = tic,
@@ -138,8 +233,8 @@ void initRun(Run* run, Console* console, tic_mem* tic)
         {
             .error = onError,
             .trace = onTrace,
-            .counter = getSystem()->getPerformanceCounter,
-            .freq = getSystem()->getPerformanceFrequency,
+            .counter = getCounter,
+            .freq = getFreq,
             .start = 0,
             .data = run,
             .exit = onExit,
@@ -166,10 +261,16 @@ void initRun(Run* run, Console* console, tic_mem* tic)
         memcpy(run->pmem.data, tic->ram.persistent.data, Size);
     }
 
+    // rewind saves the whole machine after every frame, it's only on when asked for,
+    // scripts that can't save their state play without it
+    if(getConfig()->rewind && tic_core_script_config(tic)->save)
+        run->rewind.history = tic_rewind_create(REWIND_BUDGET);
+
     getSystem()->preseed();
 }
 
 void freeRun(Run* run)
 {
+    freeRewind(run);
     free(run);
 }
\ No newline at end of file
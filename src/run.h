@@ -23,6 +23,7 @@
 #pragma once
 
 #include "studio.h"
+#include "rewind.h"
 
 typedef struct Run Run;
 
@@ -37,6 +38,19 @@ struct Run
     char saveid[TICNAME_MAX];
     tic_persistent pmem;
 
+    // saved states of the frames played, F10 steps back through them; NULL when it's off
+    struct
+    {
+        tic_rewind* history;
+        void* state;
+        s32 size;
+        bool active;
+
+        // performance counter ticks spent saving and the frames saved
+        u64 cost;
+        s32 frames;
+    } rewind;
+
     void(*tick)(Run*);
 };
 
@@ -1310,7 +1310,7 @@ static void drawSheetOvr(Sprite* sprite, s32 x, s32 y)
 static void drawSheet(Sprite* sprite, s32 x, s32 y)
 {
     tic_mem* tic = sprite->tic;
-    tiles2ram(&tic->ram, sprite->src);
+    tiles2ram(tic, sprite->src);
     tic_tool_poke4(&tic->ram.vram.blit, 0, sprite->nbPages * (2 +sprite->bank) + sprite->page);
     tic_api_spr(tic, 0, x, y, SHEET_COLS, SHEET_COLS, NULL, 0, 1, tic_no_flip, tic_no_rotate);
     tic_tool_poke4(&tic->ram.vram.blit, 0, 2);
@@ -359,7 +359,7 @@ static SQInteger squirrel_textri(HSQUIRRELVM vm)
         }
 
         tic_mem* tic = (tic_mem*)getSquirrelMachine(vm);
-        static u8 colors[TIC_PALETTE_SIZE];
+        u8 colors[TIC_PALETTE_SIZE];
         s32 count = 0;
         bool use_map = false;
 
@@ -505,7 +505,7 @@ static SQInteger squirrel_spr(HSQUIRRELVM vm)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     if(top >= 2) 
@@ -620,7 +620,7 @@ typedef struct
     HSQOBJECT reg;
 } RemapData;
 
-static void remapCallback(void* data, s32 x, s32 y, RemapResult* result)
+static void remapTile(void* data, s32 x, s32 y, RemapResult* result)
 {
     RemapData* remap = (RemapData*)data;
     HSQUIRRELVM vm = remap->vm;
@@ -659,6 +659,12 @@ static void remapCallback(void* data, s32 x, s32 y, RemapResult* result)
     sq_settop(vm, top);
 }
 
+static void remapCallback(void* data, s32 x, s32 y, s32 count, RemapResult* result)
+{
+    for(s32 i = 0; i < count; i++)
+        remapTile(data, x + i, y, result + i);
+}
+
 static SQInteger squirrel_map(HSQUIRRELVM vm)
 {
     s32 x = 0;
@@ -668,7 +674,7 @@ static SQInteger squirrel_map(HSQUIRRELVM vm)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     SQInteger top = sq_gettop(vm);
@@ -819,7 +825,8 @@ static SQInteger squirrel_sfx(HSQUIRRELVM vm)
         {
             if (index >= 0)
             {
-                tic_sample* effect = tic->ram.sfx.samples.data + index;
+                tic_core_materialize(tic, offsetof(tic_ram, sfx.samples) + index * sizeof(tic_sample), sizeof(tic_sample));
+                const tic_sample* effect = tic->ram.sfx.samples.data + index;
 
                 note = effect->note;
                 octave = effect->octave;
@@ -42,7 +42,6 @@
 
 #include "ext/gif.h"
 #include "ext/md5.h"
-#include "wave_writer.h"
 
 #include <zlib.h>
 #include <ctype.h>
@@ -242,21 +241,25 @@ static struct
     .argv = NULL,
 };
 
-static const char WavPath[] = TIC_CACHE "temp.wav";
-
 void map2ram(tic_ram* ram, const tic_map* src)
 {
     memcpy(ram->map.data, src, sizeof ram->map);
 }
 
-void tiles2ram(tic_ram* ram, const tic_tiles* src)
+void tiles2ram(tic_mem* tic, const tic_tiles* src)
 {
-    memcpy(ram->tiles.data, src, sizeof ram->tiles * TIC_SPRITE_BANKS);
+    memcpy(tic->ram.tiles.data, src, sizeof tic->ram.tiles * TIC_SPRITE_BANKS);
+    tic_core_invalidate(tic, offsetof(tic_ram, tiles), sizeof tic->ram.tiles * TIC_SPRITE_BANKS);
 }
 
-static inline void sfx2ram(tic_ram* ram, const tic_sfx* src)
+static inline void sfx2ram(tic_mem* tic, const tic_sfx* src)
 {
-    memcpy(&ram->sfx, src, sizeof ram->sfx);
+    // the core keeps its waveforms decoded until the editors change them
+    if(memcmp(&tic->ram.sfx, src, sizeof tic->ram.sfx))
+    {
+        memcpy(&tic->ram.sfx, src, sizeof tic->ram.sfx);
+        tic_core_invalidate(tic, offsetof(tic_ram, sfx), sizeof tic->ram.sfx);
+    }
 }
 
 static inline void music2ram(tic_ram* ram, const tic_music* src)
@@ -278,95 +281,145 @@ s32 calcWaveAnimation(tic_mem* tic, u32 offset, s32 channel)
 static const tic_sfx* getSfxSrc()
 {
     tic_mem* tic = impl.studio.tic;
-    return &tic->cart.banks[impl.bank.index.sfx].sfx;
+    return &tic->cart->banks[impl.bank.index.sfx].sfx;
 }
 
 static const tic_music* getMusicSrc()
 {
     tic_mem* tic = impl.studio.tic;
-    return &tic->cart.banks[impl.bank.index.music].music;
+    return &tic->cart->banks[impl.bank.index.music].music;
 }
 
-const char* studioExportSfx(s32 index)
+enum {WavHeaderSize = 44};
+
+static u8* writeWavValue(u8* ptr, u32 value, s32 bytes)
 {
-    tic_mem* tic = impl.studio.tic;
+    for(s32 i = 0; i < bytes; i++, value >>= 8)
+        *ptr++ = value & 0xff;
 
-    const char* name = fsGetRootFilePath(impl.fs, WavPath);
+    return ptr;
+}
 
-    wave_open( impl.samplerate, name );
+// a 16 bit stereo wav the samples are appended to as they're rendered, NULL data once it's out of memory
+typedef struct
+{
+    u8* data;
+    s32 size;
+    s32 capacity;
+} WavBuffer;
 
-#if TIC_STEREO_CHANNELS == 2
-    wave_enable_stereo();
-#endif
+static void initWav(WavBuffer* wav, s32 samplerate)
+{
+    // a second of sound to start with, it doubles when that's not enough
+    wav->capacity = WavHeaderSize + samplerate * TIC_STEREO_CHANNELS * sizeof(s16);
+    wav->data = malloc(wav->capacity);
+    wav->size = WavHeaderSize;
+}
 
-    const tic_sfx* sfx = getSfxSrc();
+static void appendWav(void* data, const s16* samples, s32 count)
+{
+    WavBuffer* wav = data;
+    s32 size = count * TIC_STEREO_CHANNELS * sizeof(s16);
 
-    sfx2ram(&tic->ram, sfx);
-    music2ram(&tic->ram, getMusicSrc());
+    if(!wav->data)
+        return;
 
+    if(wav->size + size > wav->capacity)
     {
-        const tic_sample* effect = &sfx->samples.data[index];
+        wav->capacity = MAX(wav->capacity * 2, wav->size + size);
 
-        enum{Channel = 0};
-        sfx_stop(tic, Channel);
-        tic_api_sfx(tic, index, effect->note, effect->octave, -1, Channel, MAX_VOLUME, SFX_DEF_SPEED);
+        u8* grown = realloc(wav->data, wav->capacity);
 
-        for(s32 ticks = 0, pos = 0; pos < SFX_TICKS; pos = tic_tool_sfx_pos(effect->speed, ++ticks))
+        if(!grown)
         {
-            tic_core_tick_start(tic);
-            tic_core_tick_end(tic);
-
-            wave_write(tic->samples.buffer, tic->samples.size / sizeof(s16));
+            free(wav->data);
+            wav->data = NULL;
+            return;
         }
 
-        sfx_stop(tic, Channel);
-        memset(tic->ram.registers, 0, sizeof(tic_sound_register));
+        wav->data = grown;
     }
 
-    wave_close();
+    memcpy(wav->data + wav->size, samples, size);
+    wav->size += size;
+}
+
+// writes the header in front of the samples and gives the wav away
+static void* finishWav(WavBuffer* wav, s32 samplerate, s32* size)
+{
+    enum {Block = TIC_STEREO_CHANNELS * sizeof(s16)};
+
+    u8* ptr = wav->data;
+    s32 data = wav->size - WavHeaderSize;
+
+    if(ptr)
+    {
+        memcpy(ptr, "RIFF", 4);
+        ptr = writeWavValue(ptr + 4, WavHeaderSize - 8 + data, 4);
+        memcpy(ptr, "WAVEfmt ", 8);
+        ptr = writeWavValue(ptr + 8, 16, 4);
+        ptr = writeWavValue(ptr, 1, 2);
+        ptr = writeWavValue(ptr, TIC_STEREO_CHANNELS, 2);
+        ptr = writeWavValue(ptr, samplerate, 4);
+        ptr = writeWavValue(ptr, samplerate * Block, 4);
+        ptr = writeWavValue(ptr, Block, 2);
+        ptr = writeWavValue(ptr, 16, 2);
+        memcpy(ptr, "data", 4);
+        writeWavValue(ptr + 4, data, 4);
 
-    return WavPath;
+        *size = wav->size;
+    }
+
+    return wav->data;
 }
 
-const char* studioExportMusic(s32 track)
+void* studioRenderSfx(tic_mem* tic, s32 samplerate, s32 index, s32* size)
 {
-    tic_mem* tic = impl.studio.tic;
+    WavBuffer wav;
+    initWav(&wav, samplerate);
 
-    const char* name = fsGetRootFilePath(impl.fs, WavPath);
+    if(wav.data)
+        tic_core_render_sfx(tic, index, appendWav, &wav);
 
-    wave_open( impl.samplerate, name );
+    return finishWav(&wav, samplerate, size);
+}
 
-#if TIC_STEREO_CHANNELS == 2
-    wave_enable_stereo();
-#endif
+void* studioRenderMusic(tic_mem* tic, s32 samplerate, s32 track, bool sustain, u8 channels, s32* size)
+{
+    WavBuffer wav;
+    initWav(&wav, samplerate);
 
-    const tic_sfx* sfx = getSfxSrc();
-    const tic_music* music = getMusicSrc();
+    if(wav.data)
+        tic_core_render_music(tic, track, sustain, channels, appendWav, &wav);
 
-    sfx2ram(&tic->ram, sfx);
-    music2ram(&tic->ram, music);
+    return finishWav(&wav, samplerate, size);
+}
 
-    const tic_sound_state* state = &tic->ram.sound_state;
-    const Music* editor = impl.banks.music[impl.bank.index.music];
+void* studioExportSfx(s32 index, s32* size)
+{
+    tic_mem* tic = impl.studio.tic;
 
-    tic_api_music(tic, track, -1, -1, false, editor->tracker.sustain);
+    sfx2ram(tic, getSfxSrc());
+    music2ram(&tic->ram, getMusicSrc());
 
-    while(state->flag.music_state == tic_music_play)
-    {
-        tic_core_tick_start(tic);
+    return studioRenderSfx(tic, impl.samplerate, index, size);
+}
 
-        for (s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
-            if(!editor->tracker.on[i])
-                tic->ram.registers[i].volume = 0;
+void* studioExportMusic(s32 track, s32* size)
+{
+    tic_mem* tic = impl.studio.tic;
 
-        tic_core_tick_end(tic);
+    sfx2ram(tic, getSfxSrc());
+    music2ram(&tic->ram, getMusicSrc());
 
-        wave_write(tic->samples.buffer, tic->samples.size / sizeof(s16));
-    }
+    const Music* editor = impl.banks.music[impl.bank.index.music];
 
-    wave_close();
+    u8 channels = 0;
+    for (s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        if(editor->tracker.on[i])
+            channels |= 1 << i;
 
-    return WavPath;
+    return studioRenderMusic(tic, impl.samplerate, track, editor->tracker.sustain, channels, size);
 }
 
 u32 zip(u8* dest, size_t destSize, const u8* source, size_t size)
@@ -393,7 +446,7 @@ void drawBGAnimation(tic_mem* tic, s32 ticks)
 
     tic_api_cls(tic, TIC_COLOR_BG);
 
-    tiles2ram(&tic->ram, &getConfig()->cart->bank0.tiles);
+    tiles2ram(tic, &getConfig()->cart->bank0.tiles);
 
     for(s32 j = 0; j < Height + 1; j++)
         for(s32 i = 0; i < Width + 1; i++)
@@ -430,22 +483,22 @@ bool anyKeyWasPressed()
 
 tic_tiles* getBankTiles()
 {
-    return &impl.studio.tic->cart.banks[impl.bank.index.sprites].tiles;
+    return &impl.studio.tic->cart->banks[impl.bank.index.sprites].tiles;
 }
 
 tic_map* getBankMap()
 {
-    return &impl.studio.tic->cart.banks[impl.bank.index.map].map;
+    return &impl.studio.tic->cart->banks[impl.bank.index.map].map;
 }
 
 tic_palette* getBankPalette()
 {
-    return &impl.studio.tic->cart.banks[impl.bank.index.sprites].palette;
+    return &impl.studio.tic->cart->banks[impl.bank.index.sprites].palette;
 }
 
 tic_flags* getBankFlags()
 {
-    return &impl.studio.tic->cart.banks[impl.bank.index.sprites].flags;
+    return &impl.studio.tic->cart->banks[impl.bank.index.sprites].flags;
 }
 
 void playSystemSfx(s32 id)
@@ -1242,14 +1295,14 @@ static void initModules()
 
     resetBanks();
 
-    initCode(impl.code, impl.studio.tic, &tic->cart.code);
+    initCode(impl.code, impl.studio.tic, &tic->cart->code);
 
     for(s32 i = 0; i < TIC_EDITOR_BANKS; i++)
     {
-        initSprite(impl.banks.sprite[i], impl.studio.tic, &tic->cart.banks[i].tiles);
-        initMap(impl.banks.map[i], impl.studio.tic, &tic->cart.banks[i].map);
-        initSfx(impl.banks.sfx[i], impl.studio.tic, &tic->cart.banks[i].sfx);
-        initMusic(impl.banks.music[i], impl.studio.tic, &tic->cart.banks[i].music);
+        initSprite(impl.banks.sprite[i], impl.studio.tic, &tic->cart->banks[i].tiles);
+        initMap(impl.banks.map[i], impl.studio.tic, &tic->cart->banks[i].map);
+        initSfx(impl.banks.sfx[i], impl.studio.tic, &tic->cart->banks[i].sfx);
+        initMusic(impl.banks.music[i], impl.studio.tic, &tic->cart->banks[i].music);
     }
 
     initWorldMap();
@@ -1257,7 +1310,7 @@ static void initModules()
 
 static void updateHash()
 {
-    md5(&impl.studio.tic->cart, sizeof(tic_cartridge), impl.cart.hash.data);
+    md5(impl.studio.tic->cart, sizeof(tic_cartridge), impl.cart.hash.data);
 }
 
 static void updateMDate()
@@ -1294,7 +1347,7 @@ void studioRomLoaded()
 bool studioCartChanged()
 {
     CartHash hash;
-    md5(&impl.studio.tic->cart, sizeof(tic_cartridge), hash.data);
+    md5(impl.studio.tic->cart, sizeof(tic_cartridge), hash.data);
 
     return memcmp(hash.data, impl.cart.hash.data, sizeof(CartHash)) != 0;
 }
@@ -1398,7 +1451,7 @@ static void setCoverImage()
 
             screen2buffer(buffer, tic->screen, &rect);
 
-            gif_write_animation(impl.studio.tic->cart.cover.data, &impl.studio.tic->cart.cover.size,
+            gif_write_animation(impl.studio.tic->cart->cover.data, &impl.studio.tic->cart->cover.size,
                 TIC80_WIDTH, TIC80_HEIGHT, (const u8*)buffer, 1, TIC80_FRAMERATE, 1);
 
             free(buffer);
@@ -1646,7 +1699,8 @@ static void recordFrame(u32* pixels)
 
             if(impl.video.frame % TIC80_FRAMERATE < TIC80_FRAMERATE / 2)
             {
-                const u32* pal = tic_tool_palette_blit(&impl.config->cart.bank0.palette, TIC80_PIXEL_COLOR_RGBA8888);
+                u32 pal[TIC_PALETTE_SIZE];
+                tic_tool_palette_blit(pal, &impl.config->cart.bank0.palette, TIC80_PIXEL_COLOR_RGBA8888);
                 drawRecordLabel(pixels, TIC80_WIDTH-24, 8, &pal[tic_color_2]);
             }
 
@@ -1710,7 +1764,7 @@ static void renderStudio()
             music = getMusicSrc();
         }
 
-        sfx2ram(&tic->ram, sfx);
+        sfx2ram(tic, sfx);
         music2ram(&tic->ram, music);
 
         tic_core_tick_start(impl.studio.tic);
@@ -1760,7 +1814,10 @@ static void renderStudio()
     }
 
     if(getConfig()->noSound)
+    {
         memset(tic->ram.registers, 0, sizeof tic->ram.registers);
+        tic_core_invalidate(tic, offsetof(tic_ram, registers), sizeof tic->ram.registers);
+    }
 
     tic_core_tick_end(impl.studio.tic);
 
@@ -1790,6 +1847,7 @@ static void updateSystemFont()
                     impl.systemFont.data[i*BITS_IN_BYTE+y] |= 1 << x;
 
     memcpy(tic->ram.font.data, impl.systemFont.data, sizeof(tic_font));
+    tic_core_invalidate(tic, offsetof(tic_ram, font), sizeof(tic_font));
 }
 
 void studioConfigChanged()
@@ -1800,6 +1858,8 @@ void studioConfigChanged()
 
     updateSystemFont();
 
+    tic_core_deferred(impl.studio.tic, getConfig()->drawThreads);
+
     getSystem()->updateConfig();
 }
 
@@ -1904,6 +1964,7 @@ static void studioTick()
         {
             memcpy(tic->ram.vram.palette.data, getConfig()->cart->bank0.palette.data, sizeof(tic_palette));
             memcpy(tic->ram.font.data, impl.systemFont.data, sizeof(tic_font));
+            tic_core_invalidate(tic, offsetof(tic_ram, font), sizeof(tic_font));
         }
 
         data
@@ -177,8 +177,11 @@ System* getSystem();
 const char* md5str(const void* data, s32 length);
 bool hasProjectExt(const char* name);
 void sfx_stop(tic_mem* tic, s32 channel);
-const char* studioExportMusic(s32 track);
-const char* studioExportSfx(s32 sfx);
+// wav images rendered in memory from the sfx and music in ram, the caller frees them
+void* studioRenderSfx(tic_mem* tic, s32 samplerate, s32 index, s32* size);
+void* studioRenderMusic(tic_mem* tic, s32 samplerate, s32 track, bool sustain, u8 channels, s32* size);
+void* studioExportMusic(s32 track, s32* size);
+void* studioExportSfx(s32 sfx, s32* size);
 s32 calcWaveAnimation(tic_mem* tic, u32 index, s32 channel);
 void map2ram(tic_ram* ram, const tic_map* src);
-void tiles2ram(tic_ram* ram, const tic_tiles* src);
+void tiles2ram(tic_mem* tic, const tic_tiles* src);
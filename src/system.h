@@ -161,6 +161,9 @@ typedef struct
     bool showSync;
     bool crtMonitor;
     bool goFullscreen;
+    bool audioStats;
+    s32 drawThreads;
+    bool rewind;
 
     const char* crtShader;
     const tic_cartridge* cart;
@@ -75,6 +75,20 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       0
    },
+   {
+      "tic80_run_ahead",
+      "Run-Ahead Frames",
+      "Show the screen this many frames ahead of the game to hide input lag. The frames are run again every frame, carts that can't save their state run without it.",
+      {
+         { "disabled", NULL },
+         { "1",        NULL },
+         { "2",        NULL },
+         { "3",        NULL },
+         { "4",        NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
    { NULL, NULL, NULL, {{0}}, NULL },
 };
 
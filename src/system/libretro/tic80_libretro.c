@@ -20,6 +20,10 @@
 // How long to wait before hiding the mouse.
 #define TIC_LIBRETRO_MOUSE_HIDE_TIMER_START 300
 
+// The fixed size reported for save states: the machine takes about 100 KB of it, the script state gets the rest.
+// Larger states aren't saved, so the size never changes while the content runs.
+#define TIC_LIBRETRO_SERIALIZE_SIZE (1024 * 1024)
+
 static struct retro_log_callback logging;
 static retro_log_printf_t log_cb;
 static retro_video_refresh_t video_cb;
@@ -35,10 +39,13 @@ static struct
 	tic80_input input;
 	int keymap[RETROK_LAST];
 	bool variablePointerApi;
+	bool canDupe;
 	u8 mouseCursor;
 	u16 mousePreviousX;
 	u16 mousePreviousY;
 	u16 mouseHideTimer;
+	int runAhead;
+	bool serializeTooLarge;
 } state =
 {
 	.quit = false,
@@ -559,8 +566,11 @@ static void tic80_libretro_draw(tic80* game)
 	// Mouse Cursor
 	tic80_libretro_mousecursor((tic80_local*)game, &state.input.mouse, state.mouseCursor);
 
+	// Reuse the last frame when nothing has changed on the screen.
+	bool changed = game->screen_dirty.top < game->screen_dirty.bottom || state.mouseHideTimer > 0;
+
 	// Render to the screen.
-	video_cb(game->screen, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, TIC80_FULLWIDTH << 2);
+	video_cb(changed || !state.canDupe ? game->screen : NULL, TIC80_FULLWIDTH, TIC80_FULLHEIGHT, TIC80_FULLWIDTH << 2);
 }
 
 /**
@@ -607,6 +617,14 @@ static void tic80_libretro_variables(void)
 			state.mouseCursor = 3;
 		}
 	}
+
+	// Run-Ahead
+	state.runAhead = 0;
+	var.key = "tic80_run_ahead";
+	var.value = NULL;
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+		state.runAhead = atoi(var.value);
+	}
 }
 
 /**
@@ -632,12 +650,15 @@ void retro_run(void)
 	// Update the TIC-80 environment.
 	tic80_libretro_update(tic);
 
+	// Play the audio, the frames run ahead are silent.
+	tic80_libretro_audio(tic);
+
+	// Show the screen a few frames ahead with the same input.
+	tic80_tick_ahead(tic, &state.input, state.runAhead);
+
 	// Render the screen.
 	tic80_libretro_draw(tic);
 
-	// Play the audio.
-	tic80_libretro_audio(tic);
-
 	// Update core options, if needed.
 	bool updated = false;
 	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated) {
@@ -651,7 +672,6 @@ void retro_run(void)
 bool retro_load_game(const struct retro_game_info *info)
 {
 	// TODO: Warn that Audio Synchronization required to run at a proper speed.
-	// TODO: Warn that the core doesn't support Runahead.
 
 	// Pixel format.
 	enum retro_pixel_format fmt = RETRO_PIXEL_FORMAT_XRGB8888;
@@ -663,6 +683,11 @@ bool retro_load_game(const struct retro_game_info *info)
 	// Update the input button descriptions.
 	tic80_libretro_input_descriptors();
 
+	// Frames without screen changes can be skipped.
+	if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &state.canDupe)) {
+		state.canDupe = false;
+	}
+
 	// Check for the content.
 	if (!info) {
 		log_cb(RETRO_LOG_ERROR, "[TIC-80] No content information provided.\n");
@@ -734,47 +759,46 @@ bool retro_load_game_special(unsigned type, const struct retro_game_info *info,
 }
 
 /**
- * libretro callback; Retrieve the size of the serialized memory.
+ * libretro callback; Retrieve the size of the serialized machine state.
  */
 size_t retro_serialize_size(void)
 {
-	return TIC_PERSISTENT_SIZE * sizeof(u32);
+	// Frontends allocate the buffer once, so it's always the same maximum.
+	return tic ? TIC_LIBRETRO_SERIALIZE_SIZE : 0;
 }
 
 /**
- * libretro callback; Get the current persistent memory.
+ * libretro callback; Save the whole machine state, including the script state.
  */
 bool retro_serialize(void *data, size_t size)
 {
-	if (!tic || !data) {
+	if (!tic || !data || size < TIC_LIBRETRO_SERIALIZE_SIZE) {
 		return false;
 	}
 
-	tic80_local* tic80 = (tic80_local*)tic;
-	u32* udata = (u32*)data;
-	for (int i = 0; i < TIC_PERSISTENT_SIZE; i++) {
-		udata[i] = tic80->memory->ram.persistent.data[i];
+	// Fails above the maximum whatever the buffer given, a state that fits is always loadable.
+	s32 saved = tic80_save_state(tic, data, TIC_LIBRETRO_SERIALIZE_SIZE);
+	if (saved <= 0 || saved > TIC_LIBRETRO_SERIALIZE_SIZE) {
+		if (saved > 0 && !state.serializeTooLarge) {
+			log_cb(RETRO_LOG_WARN, "[TIC-80] The machine state takes %d bytes, more than the %d bytes allowed.\n", saved, TIC_LIBRETRO_SERIALIZE_SIZE);
+			state.serializeTooLarge = true;
+		}
+		return false;
 	}
 
 	return true;
 }
 
 /**
- * libretro callback; Given the serialized data, load it into the persistent memory.
+ * libretro callback; Restore the machine state saved by retro_serialize().
  */
 bool retro_unserialize(const void *data, size_t size)
 {
-	if (!tic || size != retro_serialize_size() || !data) {
+	if (!tic || !data) {
 		return false;
 	}
 
-	tic80_local* tic80 = (tic80_local*)tic;
-	u32* uData = (u32*)data;
-	for (int i = 0; i < TIC_PERSISTENT_SIZE; i++) {
-		tic80->memory->ram.persistent.data[i] = uData[i];
-	}
-
-	return true;
+	return tic80_load_state(tic, data, (s32)size);
 }
 
 /**
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
 #include <time.h>
 
 #include <SDL_gpu.h>
@@ -36,6 +37,12 @@
 
 #define STUDIO_PIXEL_FORMAT GPU_FORMAT_RGBA
 #define TEXTURE_SIZE (TIC80_FULLWIDTH)
+// device buffer and the frames of sound queued ahead of it
+#define AUDIO_BUFFER_SAMPLES 512
+#define AUDIO_QUEUE_FRAMES 4
+// the queue is held around the target by playing up to MAX_SKEW / TIC_AUDIO_RATE faster or slower
+#define AUDIO_TARGET_FRAMES 2
+#define AUDIO_MAX_SKEW 50
 
 #if defined(__TIC_WINRT__) || defined(__TIC_WINDOWS__)
 #include <windows.h>
@@ -74,6 +81,7 @@ static struct
     {
         GPU_Target* screen;
         GPU_Image* texture;
+        bool refresh;
 
 #if defined(CRT_SHADER_SUPPORT)
         u32 shader;
@@ -146,7 +154,14 @@ static struct
     {
         SDL_AudioSpec       spec;
         SDL_AudioDeviceID   device;
-        SDL_AudioCVT        cvt;
+
+        // rate control, the queue length is smoothed over the frames it's measured on
+        // and drift builds up the skew a steady speed difference needs
+        float queued;
+        float drift;
+        s32 rate;
+
+        GPU_Image* stats;
     } audio;
 } platform
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -163,24 +178,45 @@ static inline bool crtMonitorEnabled()
 }
 #endif
 
+// pulls the sound the ticks queued, it runs on the SDL audio thread
+static void audioCallback(void* userdata, u8* stream, s32 len)
+{
+    tic_mem* tic = platform.studio->tic;
+
+    if(platform.audio.spec.format == AUDIO_F32SYS)
+    {
+        s32 count = len / (sizeof(float) * TIC_STEREO_CHANNELS);
+        s16* samples = (s16*)stream;
+        float* out = (float*)stream;
+
+        // rendered into the first half of the stream and widened from the end, every float lands on samples already read
+        tic_core_synth(tic, samples, count);
+
+        for(s32 i = count * TIC_STEREO_CHANNELS - 1; i >= 0; i--)
+            out[i] = samples[i] / 32768.0f;
+    }
+    else tic_core_synth(tic, (s16*)stream, len / (sizeof(s16) * TIC_STEREO_CHANNELS));
+}
+
 static void initSound()
 {
     SDL_AudioSpec want =
     {
         .freq = TIC80_SAMPLERATE,
-        .format = AUDIO_S16,
+        .format = AUDIO_S16SYS,
         .channels = TIC_STEREO_CHANNELS,
+        .samples = AUDIO_BUFFER_SAMPLES,
+        .callback = audioCallback,
         .userdata = NULL,
     };
 
+    // the core synthesizes at the device rate and in its format when it's s16 or f32
     platform.audio.device = SDL_OpenAudioDevice(NULL, 0, &want, &platform.audio.spec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_FORMAT_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
 
-    SDL_BuildAudioCVT(&platform.audio.cvt, want.format, want.channels, platform.audio.spec.freq, platform.audio.spec.format, platform.audio.spec.channels, platform.audio.spec.freq);
-
-    if(platform.audio.cvt.needed)
+    if(platform.audio.device && platform.audio.spec.format != AUDIO_S16SYS && platform.audio.spec.format != AUDIO_F32SYS)
     {
-        platform.audio.cvt.len = platform.audio.spec.freq * platform.audio.spec.channels * sizeof(s16) / TIC80_FRAMERATE;
-        platform.audio.cvt.buf = SDL_malloc(platform.audio.cvt.len * platform.audio.cvt.len_mult);
+        SDL_CloseAudioDevice(platform.audio.device);
+        platform.audio.device = SDL_OpenAudioDevice(NULL, 0, &want, &platform.audio.spec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
     }
 }
 
@@ -202,7 +238,8 @@ static void setWindowIcon()
 
     u32* pixels = SDL_malloc(Size * Size * sizeof(u32));
 
-    const u32* pal = tic_tool_palette_blit(&platform.studio->config()->cart->bank0.palette, platform.studio->tic->screen_format);
+    u32 pal[TIC_PALETTE_SIZE];
+    tic_tool_palette_blit(pal, &platform.studio->config()->cart->bank0.palette, platform.studio->tic->screen_format);
 
     for(s32 j = 0, index = 0; j < Size; j++)
         for(s32 i = 0; i < Size; i++, index++)
@@ -258,6 +295,7 @@ static void map2ram()
     tic_mem* tic = platform.studio->tic;
     memcpy(tic->ram.map.data, &platform.studio->config()->cart->bank0.map, sizeof tic->ram.map);
     memcpy(tic->ram.tiles.data, &platform.studio->config()->cart->bank0.tiles, sizeof tic->ram.tiles * TIC_SPRITE_BANKS);
+    tic_core_invalidate(tic, offsetof(tic_ram, tiles), sizeof tic->ram.tiles * TIC_SPRITE_BANKS);
 }
 
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -277,7 +315,8 @@ static void initTouchGamepad()
 
             const u8* in = platform.studio->tic->ram.vram.screen.data;
             const u8* end = in + sizeof(platform.studio->tic->ram.vram.screen);
-            const u32* pal = tic_tool_palette_blit(&platform.studio->config()->cart->bank0.palette, platform.studio->tic->screen_format);
+            u32 pal[TIC_PALETTE_SIZE];
+            tic_tool_palette_blit(pal, &platform.studio->config()->cart->bank0.palette, platform.studio->tic->screen_format);
             const u32 Delta = ((TIC80_FULLWIDTH*sizeof(u32))/sizeof *out - TIC80_WIDTH);
 
             s32 col = 0;
@@ -304,6 +343,7 @@ static void initTouchGamepad()
 
         memset(&platform.studio->tic->ram.map, 0, sizeof(tic_map));
         memset(&platform.studio->tic->ram.tiles, 0, sizeof(tic_tiles) * TIC_SPRITE_BANKS);
+        tic_core_invalidate(platform.studio->tic, offsetof(tic_ram, tiles), sizeof(tic_tiles) * TIC_SPRITE_BANKS);
     }
 
     if(!platform.gamepad.touch.texture)
@@ -334,6 +374,7 @@ static void initGPU()
     platform.gpu.texture = GPU_CreateImage(TIC80_FULLWIDTH, TIC80_FULLHEIGHT, STUDIO_PIXEL_FORMAT);
     GPU_SetAnchor(platform.gpu.texture, 0, 0);
     GPU_SetImageFilter(platform.gpu.texture, GPU_FILTER_NEAREST);
+    platform.gpu.refresh = true;
 
 #if defined(TOUCH_INPUT_SUPPORT)
     initTouchGamepad();
@@ -360,6 +401,12 @@ static void destroyGPU()
     }
 #endif
 
+    if(platform.audio.stats)
+    {
+        GPU_FreeImage(platform.audio.stats);
+        platform.audio.stats = NULL;
+    }
+
     if(platform.mouse.texture)
     {
         GPU_FreeImage(platform.mouse.texture);
@@ -899,6 +946,26 @@ static void pollEvent()
     processGamepad();
 }
 
+// uploads only the screen rows changed by the last blit
+static void updateGpuTexture(tic_mem* tic)
+{
+    s32 top = tic->screen_dirty.top;
+    s32 bottom = tic->screen_dirty.bottom;
+
+    if(platform.gpu.refresh)
+    {
+        top = 0;
+        bottom = TIC80_FULLHEIGHT;
+        platform.gpu.refresh = false;
+    }
+
+    if(top < bottom)
+    {
+        GPU_Rect rect = {0, top, TIC80_FULLWIDTH, bottom - top};
+        GPU_UpdateImageBytes(platform.gpu.texture, &rect, (const u8*)(tic->screen + top * TIC80_FULLWIDTH), TIC80_FULLWIDTH * sizeof(u32));
+    }
+}
+
 static void blitGpuTexture(GPU_Target* screen, GPU_Image* texture)
 {
     SDL_Rect rect = {0, 0, 0, 0};
@@ -934,19 +1001,95 @@ static void blitGpuTexture(GPU_Target* screen, GPU_Image* texture)
     }
 }
 
-static void blitSound()
+static inline float clampSkew(float skew)
+{
+    return skew < -1.0f ? -1.0f : skew > 1.0f ? 1.0f : skew;
+}
+
+// vsync and load make the ticks run a bit faster or slower than the device plays,
+// the queue drifts away from the target and the sound is stretched a few tenths of percent to bring it back
+static void controlAudioRate()
 {
     tic_mem* tic = platform.studio->tic;
 
+    enum {Smoothing = 16, Inertia = 256};
+    const float Target = (float)AUDIO_TARGET_FRAMES * platform.audio.spec.freq / TIC80_FRAMERATE;
+
+    platform.audio.queued += (tic_core_audio_queued(tic) - platform.audio.queued) / Smoothing;
+
+    float skew = clampSkew((platform.audio.queued - Target) / Target);
+    platform.audio.drift = clampSkew(platform.audio.drift + skew / Inertia);
+
+    platform.audio.rate = TIC_AUDIO_RATE + (s32)(clampSkew(skew + platform.audio.drift) * AUDIO_MAX_SKEW);
+    tic_core_audio_rate(tic, platform.audio.rate);
+}
+
+static void blitSound()
+{
+    controlAudioRate();
+
+    // the ticks queue a frame before the audio thread starts pulling them
     SDL_PauseAudioDevice(platform.audio.device, 0);
-    
-    if(platform.audio.cvt.needed)
+}
+
+static void drawStatsText(u32* pixels, s32 width, const char* text, s32 x, s32 y, u32 color)
+{
+    const u8* font = platform.studio->tic->ram.font.data;
+
+    for(; *text && x + TIC_FONT_WIDTH <= width; text++, x += TIC_FONT_WIDTH)
     {
-        SDL_memcpy(platform.audio.cvt.buf, tic->samples.buffer, tic->samples.size);
-        SDL_ConvertAudio(&platform.audio.cvt);
-        SDL_QueueAudio(platform.audio.device, platform.audio.cvt.buf, platform.audio.cvt.len_cvt);
+        const u8* rows = font + (u8)*text * BITS_IN_BYTE;
+
+        for(s32 row = 0; row < TIC_FONT_HEIGHT; row++)
+            for(s32 col = 0; col < TIC_FONT_WIDTH; col++)
+                if(rows[row] & (1 << col))
+                    pixels[(y + row) * width + x + col] = color;
     }
-    else SDL_QueueAudio(platform.audio.device, tic->samples.buffer, tic->samples.size);
+}
+
+// audio latency, the rate the controller holds it with and the times the device ran dry
+static void renderAudioStats()
+{
+    enum {Width = TIC_FONT_WIDTH * 24 + 2, Height = TIC_FONT_HEIGHT * 2 + 3, Back = 0, Text = 12};
+
+    if(!platform.audio.stats)
+    {
+        platform.audio.stats = GPU_CreateImage(Width, Height, STUDIO_PIXEL_FORMAT);
+        GPU_SetAnchor(platform.audio.stats, 0, 0);
+        GPU_SetImageFilter(platform.audio.stats, GPU_FILTER_NEAREST);
+    }
+
+    tic_mem* tic = platform.studio->tic;
+
+    u32 pal[TIC_PALETTE_SIZE];
+    tic_tool_palette_blit(pal, &platform.studio->config()->cart->bank0.palette, tic->screen_format);
+
+    static u32 pixels[Width * Height];
+    for(s32 i = 0; i < COUNT_OF(pixels); i++)
+        pixels[i] = pal[Back];
+
+    {
+        // the device buffer plays before anything queued
+        float ms = 1000.0f / platform.audio.spec.freq;
+        float latency = (platform.audio.queued + platform.audio.spec.samples) * ms;
+        float target = ((float)AUDIO_TARGET_FRAMES * platform.audio.spec.freq / TIC80_FRAMERATE + platform.audio.spec.samples) * ms;
+
+        char text[32];
+        sprintf(text, "audio %.1f/%.1fms", latency, target);
+        drawStatsText(pixels, Width, text, 1, 1, pal[Text]);
+
+        sprintf(text, "rate %+.2f%% under %i", (platform.audio.rate - TIC_AUDIO_RATE) * 100.0f / TIC_AUDIO_RATE,
+            tic_core_audio_underruns(tic));
+        drawStatsText(pixels, Width, text, 1, TIC_FONT_HEIGHT + 2, pal[Text]);
+    }
+
+    GPU_UpdateImageBytes(platform.audio.stats, NULL, (const u8*)pixels, Width * sizeof(u32));
+
+    SDL_Rect rect = {0, 0, 0, 0};
+    calcTextureRect(&rect);
+    s32 scale = rect.w / TIC80_WIDTH;
+
+    GPU_BlitScale(platform.audio.stats, NULL, platform.gpu.screen, rect.x, rect.y, (float)scale, (float)scale);
 }
 
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -1014,7 +1157,8 @@ static void blitCursor(const u8* in)
         platform.mouse.src = in;
 
         const u8* end = in + sizeof(tic_tile);
-        const u32* pal = tic_tool_palette_blit(&platform.studio->tic->ram.vram.palette, platform.studio->tic->screen_format);
+        u32 pal[TIC_PALETTE_SIZE];
+        tic_tool_palette_blit(pal, &platform.studio->tic->ram.vram.palette, platform.studio->tic->screen_format);
         static u32 data[TIC_SPRITESIZE*TIC_SPRITESIZE];
         u32* out = data;
 
@@ -1393,7 +1537,7 @@ static void gpuTick()
     {
         platform.studio->tick();
 
-        GPU_UpdateImageBytes(platform.gpu.texture, NULL, (const u8*)tic->screen, TIC80_FULLWIDTH * sizeof(u32));
+        updateGpuTexture(tic);
 
 #if defined(CRT_SHADER_SUPPORT)            
         if(platform.studio->config()->crtMonitor)
@@ -1428,6 +1572,9 @@ static void gpuTick()
             blitGpuTexture(platform.gpu.screen, platform.gpu.texture);
         }
 
+        if(platform.studio->config()->audioStats)
+            renderAudioStats();
+
         renderCursor();
 
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -1485,6 +1632,8 @@ static s32 start(s32 argc, char **argv, const char* folder)
     platform.net = createNet();
 
     platform.studio = studioInit(argc, argv, platform.audio.spec.freq, folder, &systemInterface);
+    tic_core_audio_thread(platform.studio->tic, AUDIO_QUEUE_FRAMES);
+    platform.audio.rate = TIC_AUDIO_RATE;
 
     const s32 Width = TIC80_FULLWIDTH * platform.studio->config()->uiScale;
     const s32 Height = TIC80_FULLHEIGHT * platform.studio->config()->uiScale;
@@ -1533,13 +1682,13 @@ static s32 start(s32 argc, char **argv, const char* folder)
         SDL_StopTextInput();
 #endif
 
+    // the audio thread stops before the core it pulls from is closed
+    SDL_CloseAudioDevice(platform.audio.device);
+
     platform.studio->close();
 
     closeNet(platform.net);
 
-    if(platform.audio.cvt.buf)
-        SDL_free(platform.audio.cvt.buf);
-
     destroyGPU();
 
 #if defined(TOUCH_INPUT_SUPPORT)
@@ -1548,7 +1697,6 @@ static s32 start(s32 argc, char **argv, const char* folder)
 #endif    
 
     SDL_DestroyWindow(platform.window);
-    SDL_CloseAudioDevice(platform.audio.device);
 
     for(s32 i = 0; i < COUNT_OF(platform.mouse.cursors); i++)
         SDL_FreeCursor(platform.mouse.cursors[i]);
@@ -152,7 +152,7 @@ void sokol_gfx_init(int w, int h, int sx, int sy, bool integer_scale, bool portr
         .width = sokol_gfx.fb_width,
         .height = sokol_gfx.fb_height,
         .pixel_format = SG_PIXELFORMAT_RGBA8,
-        .usage = SG_USAGE_STREAM,
+        .usage = SG_USAGE_DYNAMIC,
         .min_filter = SG_FILTER_NEAREST,
         .mag_filter = SG_FILTER_NEAREST,
         .wrap_u = SG_WRAP_CLAMP_TO_EDGE,
@@ -210,13 +210,15 @@ static void apply_viewport(void) {
 
 void sokol_gfx_draw(const uint32_t* ptr) {
 
-    /* copy pixel data into the source texture */
-    sg_update_image(sokol_gfx.draw_state.fs_images[0], &(sg_image_content){
-        .subimage[0][0] = { 
-            .ptr = ptr,
-            .size = sokol_gfx.fb_width*sokol_gfx.fb_height*sizeof ptr[0]
-        }
-    });
+    /* copy pixel data into the source texture, NULL keeps the last frame */
+    if (ptr) {
+        sg_update_image(sokol_gfx.draw_state.fs_images[0], &(sg_image_content){
+            .subimage[0][0] = { 
+                .ptr = ptr,
+                .size = sokol_gfx.fb_width*sokol_gfx.fb_height*sizeof ptr[0]
+            }
+        });
+    }
 
     /* draw to the screen */
     sg_begin_default_pass(&gfx_draw_pass_action, sapp_width(), sapp_height());
@@ -139,6 +139,129 @@ static void resetBlitSegment(tic_mem* memory)
     memory->ram.vram.blit.segment = 2;
 }
 
+static const tic_bank* getCartBank(tic_mem* memory, s32 bank)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    return machine->cart.banks[bank] ? machine->cart.banks[bank] : &memory->cart->banks[bank];
+}
+
+// returns NULL when the copy of a shared cart bank can't be allocated
+static tic_bank* getCartBankWrite(tic_mem* memory, s32 bank)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    if(!machine->cart.shared)
+        return &memory->cart->banks[bank];
+
+    if(!machine->cart.banks[bank] && (machine->cart.banks[bank] = malloc(sizeof(tic_bank))))
+        memcpy(machine->cart.banks[bank], &memory->cart->banks[bank], sizeof(tic_bank));
+
+    return machine->cart.banks[bank];
+}
+
+static void freeCartBanks(tic_machine* machine)
+{
+    for(s32 i = 0; i < TIC_BANKS; i++)
+    {
+        free(machine->cart.banks[i]);
+        machine->cart.banks[i] = NULL;
+    }
+}
+
+enum {SyncTiles, SyncSprites, SyncMap, SyncSfx, SyncMusic, SyncPalette, SyncFlags};
+
+static const struct {s32 bank; s32 ram; s32 size;} SyncSections[] = 
+{
+    {offsetof(tic_bank, tiles),     offsetof(tic_ram, tiles),           sizeof(tic_tiles)   },
+    {offsetof(tic_bank, sprites),   offsetof(tic_ram, sprites),         sizeof(tic_tiles)   },
+    {offsetof(tic_bank, map),       offsetof(tic_ram, map),             sizeof(tic_map)     },
+    {offsetof(tic_bank, sfx),       offsetof(tic_ram, sfx),             sizeof(tic_sfx)     },
+    {offsetof(tic_bank, music),     offsetof(tic_ram, music),           sizeof(tic_music)   },
+    {offsetof(tic_bank, palette),   offsetof(tic_ram, vram.palette),    sizeof(tic_palette) },
+    {offsetof(tic_bank, flags),     offsetof(tic_ram, flags),           sizeof(tic_flags)   },
+};
+
+STATIC_ASSERT(sync_sections, COUNT_OF(SyncSections) == TIC_SYNC_SECTIONS);
+
+// section data as the last sync left it, in a cart bank or in ram
+static const u8* getSyncSection(tic_machine* machine, s32 section)
+{
+    u8 bank = machine->mapping.banks[section];
+
+    return bank 
+        ? (const u8*)getCartBank(&machine->memory, bank - 1) + SyncSections[section].bank
+        : (const u8*)&machine->memory.ram + SyncSections[section].ram;
+}
+
+// copies a mapped section into ram, skipping [keep, keep + size) that was just written there
+static void loadSyncSection(tic_machine* machine, s32 section, s32 keep, s32 size)
+{
+    if(!machine->mapping.banks[section]) return;
+
+    const u8* src = getSyncSection(machine, section);
+    u8* ram = (u8*)&machine->memory.ram;
+    s32 start = SyncSections[section].ram;
+    s32 end = start + SyncSections[section].size;
+    s32 first = MAX(keep, start);
+    s32 last = MIN(keep + size, end);
+
+    if(first >= last)
+        first = last = end;
+
+    memcpy(ram + start, src, first - start);
+    memcpy(ram + last, src + (last - start), end - last);
+
+    machine->mapping.banks[section] = 0;
+}
+
+// brings the mapped sections overlapping the range into ram, 
+// bytes of the range are kept as they are if it was written directly
+static void loadSyncSections(tic_machine* machine, s32 address, s32 size, bool written)
+{
+    if(!machine->mapping.enabled) return;
+
+    bool sheet = false;
+    s32 keep = written ? size : 0;
+
+    for(s32 i = 0; i < TIC_SYNC_SECTIONS; i++)
+    {
+        if(machine->mapping.banks[i]
+            && address < SyncSections[i].ram + SyncSections[i].size 
+            && address + size > SyncSections[i].ram)
+        {
+            // tiles and sprites are one sheet for the tile cache, they are always loaded together
+            if(i == SyncTiles || i == SyncSprites)
+                sheet = true;
+            else loadSyncSection(machine, i, address, keep);
+        }
+    }
+
+    if(sheet)
+    {
+        loadSyncSection(machine, SyncTiles, address, keep);
+        loadSyncSection(machine, SyncSprites, address, keep);
+
+        // tiles decoded from the bank are still valid for the same bytes in ram
+        machine->tilecache.tiles = machine->memory.ram.tiles.data->data;
+    }
+}
+
+static inline const tic_map* getSyncMap(tic_machine* machine)
+{
+    return (const tic_map*)getSyncSection(machine, SyncMap);
+}
+
+static inline const tic_sfx* getSyncSfx(tic_machine* machine)
+{
+    return (const tic_sfx*)getSyncSection(machine, SyncSfx);
+}
+
+static inline const tic_music* getSyncMusic(tic_machine* machine)
+{
+    return (const tic_music*)getSyncSection(machine, SyncMusic);
+}
+
 static tic_tilesheet getTileSheetFromSegment(tic_mem* memory, u8 segment)
 {
     u8* src;
@@ -147,7 +270,7 @@ static tic_tilesheet getTileSheetFromSegment(tic_mem* memory, u8 segment)
         case 1: 
             src = (u8*) &memory->ram.font.data; break;
         default:
-            src = (u8*) &memory->ram.tiles.data; break;
+            src = (u8*) getSyncSection((tic_machine*)memory, SyncTiles); break;
     }
 
     return getTileSheet(segment, src);
@@ -156,13 +279,12 @@ static tic_tilesheet getTileSheetFromSegment(tic_mem* memory, u8 segment)
 static void resetPalette(tic_mem* memory)
 {
     static const u8 DefaultMapping[] = {16, 50, 84, 118, 152, 186, 220, 254};
-    memcpy(memory->ram.vram.palette.data, memory->cart.bank0.palette.data, sizeof(tic_palette));
+    memcpy(memory->ram.vram.palette.data, getCartBank(memory, 0)->palette.data, sizeof(tic_palette));
     memcpy(memory->ram.vram.mapping, DefaultMapping, sizeof DefaultMapping);
 }
 
-static u8* getPalette(tic_mem* tic, u8* colors, u8 count)
+static u8* getPalette(tic_mem* tic, const u8* colors, u8 count, u8* mapping)
 {
-    static u8 mapping[TIC_PALETTE_SIZE];
     for (s32 i = 0; i < TIC_PALETTE_SIZE; i++) mapping[i] = tic_tool_peek4(tic->ram.vram.mapping, i);
     for (s32 i = 0; i < count; i++) mapping[colors[i]] = TRANSPARENT_COLOR;
     return mapping;
@@ -173,9 +295,21 @@ static inline u8 mapColor(tic_mem* tic, u8 color)
     return tic_tool_peek4(tic->ram.vram.mapping, color & 0xf);
 }
 
+static inline void setScreenRowDirty(tic_mem* tic, s32 y)
+{
+    ((tic_machine*)tic)->blit.rows[y] = true;
+}
+
+static void setScreenRowsDirty(tic_machine* machine, s32 top, s32 bottom)
+{
+    if(top < bottom)
+        memset(machine->blit.rows + top, true, bottom - top);
+}
+
 static void setPixelDma(tic_mem* tic, s32 x, s32 y, u8 color)
 {
     tic_tool_poke4(tic->ram.vram.screen.data, y * TIC80_WIDTH + x, color);
+    setScreenRowDirty(tic, y);
 }
 
 static inline u32* getOvrAddr(tic_mem* tic, s32 x, s32 y)
@@ -191,18 +325,54 @@ static void setPixelOvr(tic_mem* tic, s32 x, s32 y, u8 color)
     tic_machine* machine = (tic_machine*)tic;
     
     *getOvrAddr(tic, x, y) = *(machine->state.ovr.palette + color);
+    machine->blit.ovr[y] = true;
+}
+
+static inline u32 getOvrLookupSlot(u32 color)
+{
+    return (color * 2654435761u) >> (32 - TIC_OVR_LOOKUP_BITS);
+}
+
+static void initOvrLookup(tic_machine* machine)
+{
+    enum {Mask = (1 << TIC_OVR_LOOKUP_BITS) - 1};
+
+    for(s32 i = 0; i < COUNT_OF(machine->state.ovr.lookup); i++)
+        machine->state.ovr.lookup[i].index = -1;
+
+    // the first palette index wins for duplicated colors
+    for(s32 i = 0; i < TIC_PALETTE_SIZE; i++)
+    {
+        u32 color = machine->state.ovr.palette[i];
+
+        for(u32 slot = getOvrLookupSlot(color);; slot = (slot + 1) & Mask)
+        {
+            if(machine->state.ovr.lookup[slot].index < 0)
+            {
+                machine->state.ovr.lookup[slot].color = color;
+                machine->state.ovr.lookup[slot].index = i;
+                break;
+            }
+
+            if(machine->state.ovr.lookup[slot].color == color)
+                break;
+        }
+    }
 }
 
 static u8 getPixelOvr(tic_mem* tic, s32 x, s32 y)
 {
+    enum {Mask = (1 << TIC_OVR_LOOKUP_BITS) - 1};
+
     tic_machine* machine = (tic_machine*)tic;
     
     u32 color = *getOvrAddr(tic, x, y);
-    u32* pal = machine->state.ovr.palette;
 
-    for(s32 i = 0; i < TIC_PALETTE_SIZE; i++, pal++)
-        if(*pal == color)
-            return i;
+    // a full table never stops on an empty slot, the probe visits every slot once at most
+    u32 slot = getOvrLookupSlot(color);
+    for(s32 i = 0; i <= Mask && machine->state.ovr.lookup[slot].index >= 0; i++, slot = (slot + 1) & Mask)
+        if(machine->state.ovr.lookup[slot].color == color)
+            return machine->state.ovr.lookup[slot].index;
 
     return 0;
 }
@@ -214,9 +384,9 @@ static u8 getPixelDma(tic_mem* tic, s32 x, s32 y)
     return tic_tool_peek4(machine->memory.ram.vram.screen.data, y * TIC80_WIDTH + x);
 }
 
-static void setPixel(tic_machine* machine, s32 x, s32 y, u8 color)
+static void setPixel(tic_machine* machine, const tic_clip_data* clip, s32 x, s32 y, u8 color)
 {
-    if(x < machine->state.clip.l || y < machine->state.clip.t || x >= machine->state.clip.r || y >= machine->state.clip.b) return;
+    if(x < clip->l || y < clip->t || x >= clip->r || y >= clip->b) return;
 
     machine->state.setpix(&machine->memory, x, y, color);
 }
@@ -242,80 +412,292 @@ static void drawHLineDma(tic_mem* memory, s32 xl, s32 xr, s32 y, u8 color)
     if (xr & 1) {
         tic_tool_poke4(&memory->ram.vram.screen.data, y * TIC80_WIDTH + xr - 1, color);
     }
+    setScreenRowDirty(memory, y);
 }
 
 static void drawHLineOvr(tic_mem* tic, s32 x1, s32 x2, s32 y, u8 color)
 {
     tic_machine* machine = (tic_machine*)tic;
     u32 final_color = *(machine->state.ovr.palette + color);
+    u32* dst = getOvrAddr(tic, x1, y);
     for(s32 x = x1; x < x2; ++x) {
-        *getOvrAddr(tic, x, y) = final_color;
+        *dst++ = final_color;
+    }
+    machine->blit.ovr[y] = true;
+}
+
+// draws a clipped run of palette indices, TRANSPARENT_COLOR entries are skipped
+static void drawSpanDma(tic_mem* memory, const u8* colors, s32 x, s32 y, s32 width)
+{
+    const u8* end = colors + width;
+    s32 pos = y * TIC80_WIDTH + x;
+    u8* screen = memory->ram.vram.screen.data + (pos >> 1);
+
+    if((pos & 1) && colors < end)
+    {
+        if(*colors != TRANSPARENT_COLOR)
+            *screen = (*screen & 0x0f) | (*colors << 4);
+
+        colors++;
+        screen++;
+    }
+
+    for(; end - colors >= 2; colors += 2, screen++)
+    {
+        u8 lo = colors[0], hi = colors[1];
+
+        if(lo != TRANSPARENT_COLOR && hi != TRANSPARENT_COLOR)
+            *screen = lo | (hi << 4);
+        else if(lo != TRANSPARENT_COLOR)
+            *screen = (*screen & 0xf0) | lo;
+        else if(hi != TRANSPARENT_COLOR)
+            *screen = (*screen & 0x0f) | (hi << 4);
+    }
+
+    if(colors < end && *colors != TRANSPARENT_COLOR)
+        *screen = (*screen & 0xf0) | *colors;
+
+    setScreenRowDirty(memory, y);
+}
+
+static void drawSpanOvr(tic_mem* tic, const u8* colors, s32 x, s32 y, s32 width)
+{
+    tic_machine* machine = (tic_machine*)tic;
+    u32* dst = getOvrAddr(tic, x, y);
+
+    for(const u8* end = colors + width; colors < end; colors++, dst++)
+        if(*colors != TRANSPARENT_COLOR)
+            *dst = machine->state.ovr.palette[*colors];
+
+    machine->blit.ovr[y] = true;
+}
+
+// deferred flushes set the flag up front, so worker threads only read it
+static inline void setShadowDirty(tic_machine* machine)
+{
+    if(!machine->shadow.dirty)
+        machine->shadow.dirty = true;
+}
+
+static void setPixelShadow(tic_mem* tic, s32 x, s32 y, u8 color)
+{
+    tic_machine* machine = (tic_machine*)tic;
+
+    machine->shadow.pixels[y * TIC80_WIDTH + x] = color;
+    setShadowDirty(machine);
+    setScreenRowDirty(tic, y);
+}
+
+static u8 getPixelShadow(tic_mem* tic, s32 x, s32 y)
+{
+    tic_machine* machine = (tic_machine*)tic;
+
+    return machine->shadow.pixels[y * TIC80_WIDTH + x];
+}
+
+static void drawHLineShadow(tic_mem* tic, s32 xl, s32 xr, s32 y, u8 color)
+{
+    tic_machine* machine = (tic_machine*)tic;
+
+    if (xl >= xr) return;
+
+    memset(machine->shadow.pixels + y * TIC80_WIDTH + xl, color, xr - xl);
+    setShadowDirty(machine);
+    setScreenRowDirty(tic, y);
+}
+
+static void drawSpanShadow(tic_mem* tic, const u8* colors, s32 x, s32 y, s32 width)
+{
+    tic_machine* machine = (tic_machine*)tic;
+    u8* dst = machine->shadow.pixels + y * TIC80_WIDTH + x;
+
+    for(const u8* end = colors + width; colors < end; colors++, dst++)
+        if(*colors != TRANSPARENT_COLOR)
+            *dst = *colors;
+
+    setShadowDirty(machine);
+    setScreenRowDirty(tic, y);
+}
+
+static void setDrawFuncs(tic_machine* machine)
+{
+    bool shadow = machine->shadow.enabled;
+
+    machine->state.setpix = shadow ? setPixelShadow : setPixelDma;
+    machine->state.getpix = shadow ? getPixelShadow : getPixelDma;
+    machine->state.drawhline = shadow ? drawHLineShadow : drawHLineDma;
+    machine->state.drawspan = shadow ? drawSpanShadow : drawSpanDma;
+}
+
+static void flushDeferred(tic_machine* machine);
+
+// deferred draws read vram, tiles, map and font, they have to land before those change
+static void flushDeferredWrite(tic_machine* machine, s32 address, s32 size)
+{
+    enum
+    {
+        DrawEnd = offsetof(tic_ram, map) + sizeof(tic_map),
+        FontStart = offsetof(tic_ram, font), 
+        FontEnd = FontStart + sizeof(tic_font),
+    };
+
+    if(address < DrawEnd || (address < FontEnd && address + size > FontStart))
+        flushDeferred(machine);
+}
+
+// clamps a ram range to the screen bytes, returns false if they don't overlap
+static bool getScreenRange(s32 address, s32 size, s32* first, s32* last)
+{
+    enum {Start = offsetof(tic_ram, vram.screen), End = Start + sizeof(tic_screen)};
+
+    *first = MAX(address, Start) - Start;
+    *last = MIN(address + size, End) - Start;
+
+    return *first < *last;
+}
+
+static void invalidateScreenRows(tic_machine* machine, s32 address, s32 size)
+{
+    enum {Pitch = TIC80_WIDTH / 2};
+    s32 first, last;
+
+    if(getScreenRange(address, size, &first, &last))
+        setScreenRowsDirty(machine, first / Pitch, (last - 1) / Pitch + 1);
+}
+
+// finishes deferred draws and repacks shadow pixels into the VRAM screen before it is read
+static void flushScreen(tic_machine* machine, s32 address, s32 size)
+{
+    s32 first, last;
+
+    if(!getScreenRange(address, size, &first, &last)) return;
+
+    flushDeferred(machine);
+
+    if(!machine->shadow.dirty) return;
+
+    u8* dst = machine->memory.ram.vram.screen.data + first;
+    const u8* src = machine->shadow.pixels + first * 2;
+
+    for(const u8* end = machine->memory.ram.vram.screen.data + last; dst < end; dst++, src += 2)
+        *dst = (src[0] & 0xf) | (src[1] << TIC_PALETTE_BPP);
+
+    if(first == 0 && last == sizeof(tic_screen))
+        machine->shadow.dirty = false;
+}
+
+// unpacks the VRAM screen into shadow pixels after it was written
+static void unpackShadow(tic_machine* machine, s32 address, s32 size)
+{
+    s32 first, last;
+
+    if(!getScreenRange(address, size, &first, &last)) return;
+
+    const u8* src = machine->memory.ram.vram.screen.data + first;
+    u8* dst = machine->shadow.pixels + first * 2;
+
+    for(const u8* end = machine->memory.ram.vram.screen.data + last; src < end; src++)
+    {
+        *dst++ = *src & 0xf;
+        *dst++ = *src >> TIC_PALETTE_BPP;
     }
 }
 
 
 #define EARLY_CLIP(x, y, width, height) \
     ( \
-        (((y)+(height)-1) < machine->state.clip.t) \
-        || (((x)+(width)-1) < machine->state.clip.l) \
-        || ((y) >= machine->state.clip.b) \
-        || ((x) >= machine->state.clip.r) \
+        (((y)+(height)-1) < clip->t) \
+        || (((x)+(width)-1) < clip->l) \
+        || ((y) >= clip->b) \
+        || ((x) >= clip->r) \
     )
 
-static void drawHLine(tic_machine* machine, s32 x, s32 y, s32 width, u8 color)
+static void drawHLine(tic_machine* machine, const tic_clip_data* clip, s32 x, s32 y, s32 width, u8 color)
 {
-    if(y < machine->state.clip.t || machine->state.clip.b <= y) return;
+    if(y < clip->t || clip->b <= y) return;
 
-    s32 xl = MAX(x, machine->state.clip.l);
-    s32 xr = MIN(x + width, machine->state.clip.r);
+    s32 xl = MAX(x, clip->l);
+    s32 xr = MIN(x + width, clip->r);
 
     machine->state.drawhline(&machine->memory, xl, xr, y, color);
 }
 
-static void drawVLine(tic_machine* machine, s32 x, s32 y, s32 height, u8 color)
+static void drawVLine(tic_machine* machine, const tic_clip_data* clip, s32 x, s32 y, s32 height, u8 color)
 {
-    if(x < machine->state.clip.l || machine->state.clip.r <= x) return;
+    if(x < clip->l || clip->r <= x) return;
 
-    s32 yl = y < 0 ? 0 : y;
-    s32 yr = y + height >= TIC80_HEIGHT ? TIC80_HEIGHT : y + height;
+    s32 yl = MAX(y, clip->t);
+    s32 yr = MIN(y + height, clip->b);
 
     for(s32 i = yl; i < yr; ++i)
-        setPixel(machine, x, i, color);
+        machine->state.setpix(&machine->memory, x, i, color);
 }
 
-static void drawRect(tic_machine* machine, s32 x, s32 y, s32 width, s32 height, u8 color)
+static void drawRect(tic_machine* machine, const tic_clip_data* clip, s32 x, s32 y, s32 width, s32 height, u8 color)
 {
     for(s32 i = y; i < y + height; ++i)
-        drawHLine(machine, x, i, width, color);
+        drawHLine(machine, clip, x, i, width, color);
 }
 
-static void drawRectBorder(tic_machine* machine, s32 x, s32 y, s32 width, s32 height, u8 color)
+static void drawRectBorder(tic_machine* machine, const tic_clip_data* clip, s32 x, s32 y, s32 width, s32 height, u8 color)
 {
-    drawHLine(machine, x, y, width, color);
-    drawHLine(machine, x, y + height - 1, width, color);
+    drawHLine(machine, clip, x, y, width, color);
+    drawHLine(machine, clip, x, y + height - 1, width, color);
 
-    drawVLine(machine, x, y, height, color);
-    drawVLine(machine, x + width - 1, y, height, color);
+    drawVLine(machine, clip, x, y, height, color);
+    drawVLine(machine, clip, x + width - 1, y, height, color);
 }
 
-#define DRAW_TILE_BODY(X, Y) do {\
-    for(s32 py=sy; py < ey; py++, y++) \
-    { \
-        s32 xx = x; \
-        for(s32 px=sx; px < ex; px++, xx++) \
-        { \
-            u8 color = mapping[getTilePixel(tile, (X), (Y))];\
-            if(color != TRANSPARENT_COLOR) machine->state.setpix(&machine->memory, xx, y, color); \
-        } \
-    } \
-    } while(0)
+// magnifies a row of colors, only the clipped part is expanded and it is drawn once per covered line
+static void drawScaledSpan(tic_machine* machine, const tic_clip_data* clip, const u8* colors, s32 count, s32 x, s32 y, s32 scale)
+{
+    if(scale <= 0) return;
+
+    // transparent ends don't need to be expanded
+    for(; count > 0 && *colors == TRANSPARENT_COLOR; colors++, count--, x += scale);
+    for(; count > 0 && colors[count - 1] == TRANSPARENT_COLOR; count--);
+
+    s32 top = MAX(y, clip->t);
+    s32 bottom = MIN(y + scale, clip->b);
+    s32 left = MAX(x, clip->l);
+    s32 right = MIN(x + count * scale, clip->r);
+
+    if(top >= bottom || left >= right) return;
+
+    u8 row[TIC80_WIDTH];
+    s32 col = (left - x) / scale;
+    s32 rest = (left - x) % scale;
+
+    for(u8 *dst = row, *end = row + (right - left); dst < end; dst++)
+    {
+        *dst = colors[col];
+
+        if(++rest == scale)
+        {
+            rest = 0;
+            col++;
+        }
+    }
 
-#define REVERT(X) (TIC_SPRITESIZE - 1 - (X))
+    for(s32 py = top; py < bottom; py++)
+        machine->state.drawspan(&machine->memory, row, left, py, right - left);
+}
 
-static void drawTile(tic_machine* machine, tic_tileptr* tile, s32 x, s32 y, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
+// source pixel index and per column/row steps for every tile orientation
+static const struct {s32 start; s32 dx; s32 dy;} TileOrientation[] =
 {
-    u8* mapping = getPalette(&machine->memory, colors, count);
+    {0,   1,  8}, // 0b000
+    {7,  -1,  8}, // 0b001
+    {56,  1, -8}, // 0b010
+    {63, -1, -8}, // 0b011
+    {0,   8,  1}, // 0b100
+    {56, -8,  1}, // 0b101
+    {7,   8, -1}, // 0b110
+    {63, -8, -1}, // 0b111
+};
 
+static u32 getTileOrientation(tic_flip flip, tic_rotate rotate)
+{
     rotate &= 0b11;
     u32 orientation = flip & 0b11;
 
@@ -324,57 +706,65 @@ static void drawTile(tic_machine* machine, tic_tileptr* tile, s32 x, s32 y, u8*
     else if(rotate == tic_270_rotate) orientation ^= 0b010;
     if (rotate == tic_90_rotate || rotate == tic_270_rotate) orientation |= 0b100;
 
+    return orientation;
+}
+
+static void drawTile(tic_machine* machine, const tic_clip_data* clip, tic_tileptr* tile, s32 x, s32 y, const u8* mapping, s32 scale, tic_flip flip, tic_rotate rotate)
+{
+    const u32 orientation = getTileOrientation(flip, rotate);
+    u8 scratch[TIC_SPRITESIZE * TIC_SPRITESIZE];
+    const u8* pixels = getTileCachePixels(&machine->tilecache, tile, scratch);
+
     if (scale == 1) {
         // the most common path
         s32 sx, sy, ex, ey;
-        sx = machine->state.clip.l - x; if (sx < 0) sx = 0;
-        sy = machine->state.clip.t - y; if (sy < 0) sy = 0;
-        ex = machine->state.clip.r - x; if (ex > TIC_SPRITESIZE) ex = TIC_SPRITESIZE;
-        ey = machine->state.clip.b - y; if (ey > TIC_SPRITESIZE) ey = TIC_SPRITESIZE;
-        y += sy;
-        x += sx;
-        switch (orientation) {
-            case 0b100: DRAW_TILE_BODY(py, px); break;
-            case 0b110: DRAW_TILE_BODY(REVERT(py), px); break;
-            case 0b101: DRAW_TILE_BODY(py, REVERT(px)); break;
-            case 0b111: DRAW_TILE_BODY(REVERT(py), REVERT(px)); break;
-            case 0b000: DRAW_TILE_BODY(px, py); break;
-            case 0b010: DRAW_TILE_BODY(px, REVERT(py)); break;
-            case 0b001: DRAW_TILE_BODY(REVERT(px), py); break;
-            case 0b011: DRAW_TILE_BODY(REVERT(px), REVERT(py)); break;
-            default: assert(!"Unknown value of orientation in drawTile");
+        sx = clip->l - x; if (sx < 0) sx = 0;
+        sy = clip->t - y; if (sy < 0) sy = 0;
+        ex = clip->r - x; if (ex > TIC_SPRITESIZE) ex = TIC_SPRITESIZE;
+        ey = clip->b - y; if (ey > TIC_SPRITESIZE) ey = TIC_SPRITESIZE;
+
+        if(sx >= ex || sy >= ey) return;
+
+        const s32 dx = TileOrientation[orientation].dx;
+        const s32 dy = TileOrientation[orientation].dy;
+
+        for(s32 py = sy; py < ey; py++)
+        {
+            u8 row[TIC_SPRITESIZE];
+            const u8* src = pixels + TileOrientation[orientation].start + py * dy + sx * dx;
+
+            for(s32 px = sx; px < ex; px++, src += dx)
+                row[px] = mapping[*src];
+
+            machine->state.drawspan(&machine->memory, row + sx, x + sx, y + py, ex - sx);
         }
         return;
     }
 
     if (EARLY_CLIP(x, y, TIC_SPRITESIZE * scale, TIC_SPRITESIZE * scale)) return;
 
-    for(s32 py=0; py < TIC_SPRITESIZE; py++, y+=scale)
+    const s32 dx = TileOrientation[orientation].dx;
+    const s32 dy = TileOrientation[orientation].dy;
+
+    for(s32 py = 0; py < TIC_SPRITESIZE; py++, y += scale)
     {
-        s32 xx = x;
-        for(s32 px=0; px < TIC_SPRITESIZE; px++, xx+=scale)
-        {
-            s32 i;
-            s32 ix = orientation & 0b001 ? TIC_SPRITESIZE - px - 1: px;
-            s32 iy = orientation & 0b010 ? TIC_SPRITESIZE - py - 1: py;
-            if(orientation & 0b100) {
-                s32 tmp = ix; ix=iy; iy=tmp;
-            }
-            u8 color = mapping[getTilePixel(tile, ix, iy)];
-            if(color != TRANSPARENT_COLOR) drawRect(machine, xx, y, scale, scale, color);
-        }
+        u8 row[TIC_SPRITESIZE];
+        const u8* src = pixels + TileOrientation[orientation].start + py * dy;
+
+        for(s32 px = 0; px < TIC_SPRITESIZE; px++, src += dx)
+            row[px] = mapping[*src];
+
+        drawScaledSpan(machine, clip, row, TIC_SPRITESIZE, x, y, scale);
     }
 }
 
-#undef DRAW_TILE_BODY
-#undef REVERT
 
-static void drawSprite(tic_machine* machine, s32 index, s32 x, s32 y, s32 w, s32 h, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
+static void drawSprite(tic_machine* machine, const tic_clip_data* clip, u8 segment, s32 index, s32 x, s32 y, s32 w, s32 h, const u8* mapping, s32 scale, tic_flip flip, tic_rotate rotate)
 {
-    tic_tilesheet sheet = getTileSheetFromSegment(&machine->memory, machine->memory.ram.vram.blit.segment);
+    tic_tilesheet sheet = getTileSheetFromSegment(&machine->memory, segment);
     if ( w == 1 && h == 1){
         tic_tileptr tile = getTile(&sheet, index, false);
-        drawTile(machine, &tile, x, y, colors, count, scale, flip, rotate);
+        drawTile(machine, clip, &tile, x, y, mapping, scale, flip, rotate);
     }
     else
     {
@@ -383,7 +773,9 @@ static void drawSprite(tic_machine* machine, s32 index, s32 x, s32 y, s32 w, s32
 
         const tic_flip vert_horz_flip = tic_horz_flip | tic_vert_flip;
 
-        if (EARLY_CLIP(x, y, w * step, h * step)) return;
+        // rotated by 90 or 270 the sprite is h tiles wide and w tiles high
+        bool swap = rotate == tic_90_rotate || rotate == tic_270_rotate;
+        if (EARLY_CLIP(x, y, (swap ? h : w) * step, (swap ? w : h) * step)) return;
 
         for(s32 i = 0; i < w; i++)
         {
@@ -416,43 +808,119 @@ static void drawSprite(tic_machine* machine, s32 index, s32 x, s32 y, s32 w, s32
 
                 tic_tileptr tile = getTile(&sheet, index + mx+my*cols, false);
                 if(rotate==0 || rotate==2)
-                    drawTile(machine, &tile, x+i*step, y+j*step, colors, count, scale, flip, rotate);
+                    drawTile(machine, clip, &tile, x+i*step, y+j*step, mapping, scale, flip, rotate);
                 else
-                    drawTile(machine, &tile, x+j*step, y+i*step, colors, count, scale, flip, rotate);
+                    drawTile(machine, clip, &tile, x+j*step, y+i*step, mapping, scale, flip, rotate);
             }
         }
     }
 }
 
-static void drawMap(tic_machine* machine, const tic_map* src, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, u8* colors, s32 count, s32 scale, RemapFunc remap, void* data)
+static inline s32 floorDiv(s32 a, s32 b)
+{
+    return a / b - (a % b < 0);
+}
+
+static inline s32 wrapCoord(s32 value, s32 size)
 {
+    value %= size;
+    return value < 0 ? value + size : value;
+}
+
+static void drawMap(tic_machine* machine, const tic_clip_data* clip, u8 segment, const tic_map* src, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, const u8* colors, s32 count, s32 scale, RemapFunc remap, void* data)
+{
+    if(scale <= 0) return;
+
+    enum {MaxCells = TIC80_WIDTH / TIC_SPRITESIZE + 1};
+
     const s32 size = TIC_SPRITESIZE * scale;
 
-    tic_tilesheet sheet = getTileSheetFromSegment(&machine->memory, machine->memory.ram.vram.blit.segment);
+    // only the cells overlapping the clip rect are visited
+    const s32 left = MAX(0, floorDiv(clip->l - sx, size));
+    const s32 right = MIN(width, floorDiv(clip->r - sx + size - 1, size));
+    const s32 top = MAX(0, floorDiv(clip->t - sy, size));
+    const s32 bottom = MIN(height, floorDiv(clip->b - sy + size - 1, size));
+    const s32 cells = right - left;
+
+    if(cells <= 0 || top >= bottom) return;
+
+    u8 mapping[TIC_PALETTE_SIZE];
+    getPalette(&machine->memory, colors, count, mapping);
+
+    tic_tilesheet sheet = getTileSheetFromSegment(&machine->memory, segment);
 
-    for(s32 j = y, jj = sy; j < y + height; j++, jj += size)
-        for(s32 i = x, ii = sx; i < x + width; i++, ii += size)
+    const s32 lx = sx + left * size;
+
+    for(s32 j = top; j < bottom; j++)
+    {
+        const s32 mj = wrapCoord(y + j, TIC_MAP_HEIGHT);
+        const u8* mapRow = src->data + mj * TIC_MAP_WIDTH;
+
+        RemapResult row[MaxCells];
+        for(s32 i = 0; i < cells; i++)
+            row[i] = (RemapResult){mapRow[wrapCoord(x + left + i, TIC_MAP_WIDTH)], tic_no_flip, tic_no_rotate};
+
+        if(remap)
         {
-            s32 mi = i;
-            s32 mj = j;
+            // one callback per run of cells that doesn't wrap around the map edge
+            for(s32 i = 0; i < cells;)
+            {
+                s32 mi = wrapCoord(x + left + i, TIC_MAP_WIDTH);
+                s32 run = MIN(cells - i, TIC_MAP_WIDTH - mi);
 
-            while(mi < 0) mi += TIC_MAP_WIDTH;
-            while(mj < 0) mj += TIC_MAP_HEIGHT;
-            while(mi >= TIC_MAP_WIDTH) mi -= TIC_MAP_WIDTH;
-            while(mj >= TIC_MAP_HEIGHT) mj -= TIC_MAP_HEIGHT;
-            
-            s32 index = mi + mj * TIC_MAP_WIDTH;
-            RemapResult retile = { *(src->data + index), tic_no_flip, tic_no_rotate };
+                remap(data, mi, mj, run, row + i);
+                i += run;
+            }
+
+            // the callback is free to poke the palette mapping
+            getPalette(&machine->memory, colors, count, mapping);
+        }
+
+        const u8* pixels[MaxCells];
+        u8 scratch[MaxCells][TIC_SPRITESIZE * TIC_SPRITESIZE];
+        s32 dx[MaxCells], dy[MaxCells];
+
+        for(s32 i = 0; i < cells; i++)
+        {
+            tic_tileptr tile = getTile(&sheet, row[i].index, true);
+            u32 orientation = getTileOrientation(row[i].flip, row[i].rotate);
+
+            pixels[i] = getTileCachePixels(&machine->tilecache, &tile, scratch[i]) + TileOrientation[orientation].start;
+            dx[i] = TileOrientation[orientation].dx;
+            dy[i] = TileOrientation[orientation].dy;
+        }
+
+        // the whole visible tile row is drawn one pixel line at a time
+        const s32 ty = sy + j * size;
+        const s32 first = MAX(0, floorDiv(clip->t - ty, scale));
+        const s32 last = MIN(TIC_SPRITESIZE, floorDiv(clip->b - ty + scale - 1, scale));
+
+        for(s32 py = first; py < last; py++)
+        {
+            u8 line[MaxCells * TIC_SPRITESIZE];
+            u8* dst = line;
+
+            for(s32 i = 0; i < cells; i++)
+            {
+                const u8* pix = pixels[i] + py * dy[i];
+
+                for(s32 px = 0; px < TIC_SPRITESIZE; px++, pix += dx[i])
+                    *dst++ = mapping[*pix];
+            }
 
-            if (remap)
-                remap(data, mi, mj, &retile);
+            if(scale == 1)
+            {
+                s32 l = MAX(lx, clip->l);
+                s32 r = MIN(lx + cells * TIC_SPRITESIZE, clip->r);
 
-            tic_tileptr tile = getTile(&sheet, retile.index, true);
-            drawTile(machine, &tile, ii, jj, colors, count, scale, retile.flip, retile.rotate);
+                machine->state.drawspan(&machine->memory, line + (l - lx), l, ty + py, r - l);
+            }
+            else drawScaledSpan(machine, clip, line, cells * TIC_SPRITESIZE, lx, ty + py * scale, scale);
         }
+    }
 }
 
-static s32 drawChar(tic_machine* machine, tic_tileptr* font_char, s32 x, s32 y, s32 scale, bool fixed, u8* mapping)
+static s32 drawChar(tic_machine* machine, const tic_clip_data* clip, tic_tileptr* font_char, s32 x, s32 y, s32 scale, bool fixed, const u8* mapping)
 {
     enum {Size = TIC_SPRITESIZE};
 
@@ -474,63 +942,167 @@ static s32 drawChar(tic_machine* machine, tic_tileptr* font_char, s32 x, s32 y,
 
     if (EARLY_CLIP(x, y, Size * scale, Size * scale)) return width;
 
-    s32 colStart = start, colStep = 1, rowStart = 0 , rowStep = 1;
-
-    for(s32 i=0, col=colStart, xs = x; i < width; i++, col+=colStep, xs+=scale)
+    for(s32 row = 0, ys = y; row < Size; row++, ys += scale)
     {
-        for(s32 j = 0, row=rowStart, ys = y; j < Size; j++, row+=rowStep, ys+=scale)
-        {
-            u8 color = getTilePixel(font_char, col, row);
-            if(mapping[color] != TRANSPARENT_COLOR)
-                drawRect(machine, xs, ys, scale, scale, mapping[color]);
-        }
+        u8 colors[Size];
+
+        for(s32 i = 0; i < width; i++)
+            colors[i] = mapping[getTilePixel(font_char, start + i, row)];
+
+        drawScaledSpan(machine, clip, colors, width, x, ys, scale);
     }
+
     return width;
 }
 
-static s32 drawText(tic_machine* machine, tic_tilesheet* font_face, const char* text, s32 x, s32 y, s32 width, s32 height, bool fixed, u8* mapping, s32 scale, bool alt)
+// one bit per pixel, every glyph row of the system font is a mask with the leftmost pixel in bit 0
+static void prepareGlyphs(tic_machine* machine)
 {
-    s32 pos = x;
-    s32 MAX = x;
-    char sym = 0;
+    if(machine->glyphs.valid) return;
 
-    while((sym = *text++))
+    for(s32 i = 0; i < TIC_FONT_CHARS; i++)
     {
-        if(sym == '\n')
-        {
-            if(pos > MAX)
-                MAX = pos;
+        const u8* rows = machine->memory.ram.font.data + i * BITS_IN_BYTE;
+        u8 mask = 0;
 
-            pos = x;
-            y += height * scale;
-        }
-        else {
-            tic_tileptr font_char = getTile(font_face, alt*TIC_FONT_CHARS/2 + sym, true);
-            s32 size = drawChar(machine, &font_char, pos, y, scale, fixed, mapping);
-            pos += ((!fixed && size) ? size + 1 : width) * scale;
-        }
+        for(s32 row = 0; row < TIC_SPRITESIZE; row++)
+            mask |= rows[row];
+
+        s32 start = 0, end = TIC_SPRITESIZE;
+        while(start < end && !(mask & (1 << start))) start++;
+        while(end > start && !(mask & (1 << (end - 1)))) end--;
+
+        machine->glyphs.start[i] = start;
+        machine->glyphs.end[i] = end;
     }
 
-    return pos > MAX ? pos - x : MAX - x;
+    machine->glyphs.valid = true;
 }
 
-static void resetSfxPos(tic_channel_data* channel)
+static void invalidateGlyphs(tic_machine* machine, s32 address, s32 size)
 {
-    memset(channel->pos->data, -1, sizeof(tic_sfx_pos));
-    channel->tick = -1;
+    enum {Start = offsetof(tic_ram, font), End = Start + sizeof(tic_font)};
+
+    if(address < End && address + size > Start)
+        machine->glyphs.valid = false;
 }
 
-static void setChannelData(tic_mem* memory, s32 index, s32 note, s32 octave, s32 duration, tic_channel_data* channel, s32 volumeLeft, s32 volumeRight, s32 speed)
+static void invalidateWaves(tic_machine* machine, s32 address, s32 size)
 {
-    tic_machine* machine = (tic_machine*)memory;
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+    {
+        s32 start = offsetof(tic_ram, registers) + i * sizeof(tic_sound_register) + offsetof(tic_sound_register, waveform);
 
-    channel->volume.left = volumeLeft;
+        if(address < start + (s32)sizeof(tic_waveform) && address + size > start)
+            machine->waves.registers.valid[i] = false;
+    }
+
+    for(s32 i = 0; i < WAVES_COUNT; i++)
+    {
+        s32 start = offsetof(tic_ram, sfx.waveforms) + i * sizeof(tic_waveform);
+
+        if(address < start + (s32)sizeof(tic_waveform) && address + size > start)
+            machine->waves.valid[i] = false;
+    }
+}
+
+// drops everything decoded from the ram range
+static void invalidateRam(tic_machine* machine, s32 address, s32 size)
+{
+    flushDeferredWrite(machine, address, size);
+
+    invalidateTileCache(&machine->tilecache, address, size);
+    invalidateGlyphs(machine, address, size);
+    invalidateScreenRows(machine, address, size);
+    invalidateWaves(machine, address, size);
+
+    if(machine->shadow.enabled)
+        unpackShadow(machine, address, size);
+}
+
+static s32 drawGlyph(tic_machine* machine, const tic_clip_data* clip, s32 index, s32 x, s32 y, s32 scale, bool fixed, u8 color)
+{
+    enum {Size = TIC_SPRITESIZE};
+
+    s32 start = fixed ? 0 : machine->glyphs.start[index];
+    s32 width = fixed ? Size : machine->glyphs.end[index] - start;
+
+    if (EARLY_CLIP(x, y, Size * scale, Size * scale)) return width;
+
+    const u8* rows = machine->memory.ram.font.data + index * BITS_IN_BYTE;
+
+    for(s32 row = 0; row < Size; row++, y += scale)
+    {
+        u8 mask = rows[row] >> start;
+        if(!mask) continue;
+
+        u8 colors[Size];
+        for(s32 i = 0; i < width; i++, mask >>= 1)
+            colors[i] = mask & 1 ? color : TRANSPARENT_COLOR;
+
+        drawScaledSpan(machine, clip, colors, width, x, y, scale);
+    }
+
+    return width;
+}
+
+static s32 drawText(tic_machine* machine, const tic_clip_data* clip, tic_tilesheet* font_face, const char* text, s32 x, s32 y, s32 width, s32 height, bool fixed, const u8* mapping, s32 scale, bool alt)
+{
+    s32 pos = x;
+    s32 MAX = x;
+    char sym = 0;
+
+    // two color system font text goes through the cached glyph bounds
+    bool glyphs = machine->glyphs.valid 
+        && font_face->ptr == machine->memory.ram.font.data 
+        && font_face->segment->ptr_size == TIC_SPRITESIZE
+        && mapping[0] == TRANSPARENT_COLOR && mapping[1] != TRANSPARENT_COLOR;
+
+    while((sym = *text++))
+    {
+        if(sym == '\n')
+        {
+            if(pos > MAX)
+                MAX = pos;
+
+            pos = x;
+            y += height * scale;
+        }
+        else {
+            s32 size;
+
+            if(glyphs)
+                size = drawGlyph(machine, clip, (alt*TIC_FONT_CHARS/2 + sym) & (TIC_FONT_CHARS - 1), pos, y, scale, fixed, mapping[1]);
+            else
+            {
+                tic_tileptr font_char = getTile(font_face, alt*TIC_FONT_CHARS/2 + sym, true);
+                size = drawChar(machine, clip, &font_char, pos, y, scale, fixed, mapping);
+            }
+
+            pos += ((!fixed && size) ? size + 1 : width) * scale;
+        }
+    }
+
+    return pos > MAX ? pos - x : MAX - x;
+}
+
+static void resetSfxPos(tic_channel_data* channel)
+{
+    memset(channel->pos->data, -1, sizeof(tic_sfx_pos));
+    channel->tick = -1;
+}
+
+static void setChannelData(tic_mem* memory, s32 index, s32 note, s32 octave, s32 duration, tic_channel_data* channel, s32 volumeLeft, s32 volumeRight, s32 speed)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    channel->volume.left = volumeLeft;
     channel->volume.right = volumeRight;
 
     if(index >= 0)
     {
         struct {s8 speed:SFX_SPEED_BITS;} temp = {speed};
-        channel->speed = speed == temp.speed ? speed : memory->ram.sfx.samples.data[index].speed;
+        channel->speed = speed == temp.speed ? speed : getSyncSfx(machine)->samples.data[index].speed;
     }
 
     channel->note = note + octave * NOTES;
@@ -593,7 +1165,7 @@ static void setMusic(tic_machine* machine, s32 index, s32 frame, s32 row, bool l
         memory->ram.sound_state.flag.music_sustain = sustain;
         memory->ram.sound_state.flag.music_state = tic_music_play;
 
-        const tic_track* track = &memory->ram.music.tracks.data[index];
+        const tic_track* track = &getSyncMusic(machine)->tracks.data[index];
         machine->state.music.ticks = row >= 0 ? row2tick(track, row) : 0;
     }
 }
@@ -639,6 +1211,7 @@ static void soundClear(tic_mem* memory)
 
     memset(&memory->ram.registers, 0, sizeof memory->ram.registers);
     memset(memory->samples.buffer, 0, memory->samples.size);
+    ZEROMEM(machine->waves.registers.valid);
 
     stopMusic(memory);
 }
@@ -662,6 +1235,8 @@ void tic_api_clip(tic_mem* memory, s32 x, s32 y, s32 width, s32 height)
 
 void tic_api_reset(tic_mem* memory)
 {
+    flushDeferred((tic_machine*)memory);
+
     resetPalette(memory);
     resetBlitSegment(memory);
 
@@ -675,10 +1250,9 @@ void tic_api_reset(tic_mem* memory)
     machine->state.initialized = false;
     machine->state.scanline = NULL;
     machine->state.ovr.callback = NULL;
+    initOvrLookup(machine);
 
-    machine->state.setpix = setPixelDma;
-    machine->state.getpix = getPixelDma;
-    machine->state.drawhline = drawHLineDma;
+    setDrawFuncs(machine);
 
     updateSaveid(memory);
 }
@@ -687,11 +1261,14 @@ void tic_core_pause(tic_mem* memory)
 {
     tic_machine* machine = (tic_machine*)memory;
 
+    flushScreen(machine, 0, sizeof(tic_ram));
+    loadSyncSections(machine, 0, sizeof(tic_ram), false);
+
     memcpy(&machine->pause.state, &machine->state, sizeof(tic_machine_state_data));
     memcpy(&machine->pause.ram, &memory->ram, sizeof(tic_ram));
 
     machine->pause.time.start = machine->data->start;
-    machine->pause.time.paused = machine->data->counter();
+    machine->pause.time.paused = machine->data->counter(machine->data->data);
 }
 
 void tic_core_resume(tic_mem* memory)
@@ -702,8 +1279,9 @@ void tic_core_resume(tic_mem* memory)
     {
         memcpy(&machine->state, &machine->pause.state, sizeof(tic_machine_state_data));
         memcpy(&memory->ram, &machine->pause.ram, sizeof(tic_ram));
+        tic_core_invalidate(memory, 0, sizeof(tic_ram));
 
-        machine->data->start = machine->pause.time.start + machine->data->counter() - machine->pause.time.paused;
+        machine->data->start = machine->pause.time.start + machine->data->counter(machine->data->data) - machine->pause.time.paused;
     }
 }
 
@@ -741,11 +1319,102 @@ void tic_core_close(tic_mem* memory)
 
     blip_delete(machine->blip.left);
     blip_delete(machine->blip.right);
+    blip_delete(machine->audio.blip.left);
+    blip_delete(machine->audio.blip.right);
+
+    freeTileCache(&machine->tilecache);
+
+    tic_jobs_close(machine->deferred.jobs);
+    free(machine->deferred.data);
+
+    freeCartBanks(machine);
+    if(!machine->cart.shared)
+        free(memory->cart);
 
     free(memory->samples.buffer);
     free(machine);
 }
 
+typedef enum
+{
+    DeferredCls,
+    DeferredRect,
+    DeferredLine,
+    DeferredTri,
+    DeferredTextri,
+    DeferredSpr,
+    DeferredMap,
+    DeferredPrint,
+} DeferredType;
+
+// recorded draw call, textri vertices and print text are stored right after it
+typedef struct
+{
+    DeferredType type;
+    s32 size;
+
+    // rows the call can touch, used to bin it to the screen bands
+    s32 top;
+    s32 bottom;
+    tic_clip_data clip;
+
+    // sheet the tile calls read, the cart may switch it before the flush
+    u8 segment;
+
+    union
+    {
+        struct {u8 color;} cls;
+        struct {s32 x, y, width, height; u8 color;} rect;
+        struct {s32 x0, y0, x1, y1; u8 color;} line;
+        struct {s32 x1, y1, x2, y2, x3, y3; u8 color;} tri;
+        struct {s32 count; bool use_map; u8 mapping[TIC_PALETTE_SIZE];} textri;
+        struct {s32 index, x, y, w, h, scale; tic_flip flip; tic_rotate rotate; u8 mapping[TIC_PALETTE_SIZE];} spr;
+        struct {s32 x, y, width, height, sx, sy, scale; u8 colors[TIC_PALETTE_SIZE]; u8 count;} map;
+        struct {s32 x, y, width, scale; u8 color; bool fixed; bool alt;} print;
+    };
+} DeferredCommand;
+
+// returns NULL when the call has to be drawn right away
+static DeferredCommand* addDeferred(tic_machine* machine, DeferredType type, s32 top, s32 bottom, s32 extra)
+{
+    enum {Align = 8, MinCapacity = 64 * 1024};
+
+    if(!machine->deferred.active) return NULL;
+
+    s32 size = (sizeof(DeferredCommand) + extra + Align - 1) & ~(Align - 1);
+
+    if(machine->deferred.size + size > machine->deferred.capacity)
+    {
+        s32 capacity = MAX(machine->deferred.capacity * 2, MAX(MinCapacity, machine->deferred.size + size));
+        u8* data = realloc(machine->deferred.data, capacity);
+
+        if(data)
+        {
+            machine->deferred.data = data;
+            machine->deferred.capacity = capacity;
+        }
+        else
+        {
+            flushDeferred(machine);
+
+            if(size > machine->deferred.capacity)
+                return NULL;
+        }
+    }
+
+    DeferredCommand* cmd = (DeferredCommand*)(machine->deferred.data + machine->deferred.size);
+    machine->deferred.size += size;
+
+    cmd->type = type;
+    cmd->size = size;
+    cmd->clip = machine->state.clip;
+    cmd->segment = machine->memory.ram.vram.blit.segment;
+    cmd->top = MAX(top, cmd->clip.t);
+    cmd->bottom = MIN(bottom, cmd->clip.b);
+
+    return cmd;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // API ////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -753,8 +1422,17 @@ void tic_core_close(tic_mem* memory)
 void tic_api_rect(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, u8 color)
 {
     tic_machine* machine = (tic_machine*)memory;
+    DeferredCommand* cmd = addDeferred(machine, DeferredRect, y, y + height, 0);
 
-    drawRect(machine, x, y, width, height, mapColor(memory, color));
+    if(cmd)
+    {
+        cmd->rect.x = x;
+        cmd->rect.y = y;
+        cmd->rect.width = width;
+        cmd->rect.height = height;
+        cmd->rect.color = mapColor(memory, color);
+    }
+    else drawRect(machine, &machine->state.clip, x, y, width, height, mapColor(memory, color));
 }
 
 void tic_api_cls(tic_mem* memory, u8 color)
@@ -766,7 +1444,23 @@ void tic_api_cls(tic_mem* memory, u8 color)
     if(memcmp(&machine->state.clip, &EmptyClip, sizeof(tic_clip_data)) == 0)
     {
         color &= 0b00001111;
+
+        DeferredCommand* cmd = addDeferred(machine, DeferredCls, 0, TIC80_HEIGHT, 0);
+
+        if(cmd)
+        {
+            cmd->cls.color = color;
+            return;
+        }
+
         memset(memory->ram.vram.screen.data, color | (color << TIC_PALETTE_BPP), sizeof(memory->ram.vram.screen.data));     
+        setScreenRowsDirty(machine, 0, TIC80_HEIGHT);
+
+        if(machine->shadow.enabled)
+        {
+            memset(machine->shadow.pixels, color, sizeof machine->shadow.pixels);
+            machine->shadow.dirty = false;
+        }
     }
     else
     {
@@ -776,7 +1470,11 @@ void tic_api_cls(tic_mem* memory, u8 color)
 
 s32 tic_api_font(tic_mem* memory, const char* text, s32 x, s32 y, u8 chromakey, s32 w, s32 h, bool fixed, s32 scale, bool alt)
 {
-    u8* mapping = getPalette(memory, &chromakey, 1);
+    flushDeferred((tic_machine*)memory);
+    prepareGlyphs((tic_machine*)memory);
+
+    u8 mapping[TIC_PALETTE_SIZE];
+    getPalette(memory, &chromakey, 1, mapping);
 
     // Compatibility : flip top and bottom of the spritesheet
     // to preserve tic_api_font's default target
@@ -784,53 +1482,100 @@ s32 tic_api_font(tic_mem* memory, const char* text, s32 x, s32 y, u8 chromakey,
     u8 flipmask = 1; while (segment >>= 1) flipmask<<=1;
 
     tic_tilesheet font_face = getTileSheetFromSegment(memory, memory->ram.vram.blit.segment ^ flipmask);
-    return drawText((tic_machine*)memory, &font_face, text, x, y, w, h, fixed, mapping, scale, alt);
+    return drawText((tic_machine*)memory, &((tic_machine*)memory)->state.clip, &font_face, text, x, y, w, h, fixed, mapping, scale, alt);
 }
 
 s32 tic_api_print(tic_mem* memory, const char* text, s32 x, s32 y, u8 color, bool fixed, s32 scale, bool alt)
 {
+    tic_machine* machine = (tic_machine*)memory;
     u8 mapping[] = {255, color};
     tic_tilesheet font_face = getTileSheetFromSegment(memory, 1);
     // Compatibility : print uses reduced width for non-fixed space
     u8 width = alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH;
     if (!fixed) width -= 2;
-    return drawText((tic_machine*)memory, &font_face, text, x, y, width, TIC_FONT_HEIGHT, fixed, mapping, scale, alt);
+
+    prepareGlyphs(machine);
+    s32 length = (s32)strlen(text) + 1;
+    DeferredCommand* cmd = addDeferred(machine, DeferredPrint, INT32_MIN, INT32_MAX, length);
+
+    if(cmd)
+    {
+        static const tic_clip_data NoClip = {0, 0, 0, 0};
+
+        cmd->print.x = x;
+        cmd->print.y = y;
+        cmd->print.width = width;
+        cmd->print.scale = scale;
+        cmd->print.color = color;
+        cmd->print.fixed = fixed;
+        cmd->print.alt = alt;
+        memcpy(cmd + 1, text, length);
+
+        // measures the text without drawing it
+        return drawText(machine, &NoClip, &font_face, text, x, y, width, TIC_FONT_HEIGHT, fixed, mapping, scale, alt);
+    }
+
+    return drawText(machine, &machine->state.clip, &font_face, text, x, y, width, TIC_FONT_HEIGHT, fixed, mapping, scale, alt);
 }
 
 void tic_api_spr(tic_mem* memory, s32 index, s32 x, s32 y, s32 w, s32 h, u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
 {
-    drawSprite((tic_machine*)memory, index, x, y, w, h, colors, count, scale, flip, rotate);
+    tic_machine* machine = (tic_machine*)memory;
+    s32 size = MAX(w, h) * TIC_SPRITESIZE * scale;
+    DeferredCommand* cmd = scale > 0 ? addDeferred(machine, DeferredSpr, MIN(y, y + size), MAX(y, y + size), 0) : NULL;
+
+    if(cmd)
+    {
+        cmd->spr.index = index;
+        cmd->spr.x = x;
+        cmd->spr.y = y;
+        cmd->spr.w = w;
+        cmd->spr.h = h;
+        cmd->spr.scale = scale;
+        cmd->spr.flip = flip;
+        cmd->spr.rotate = rotate;
+        getPalette(memory, colors, count, cmd->spr.mapping);
+        machine->deferred.segments |= 1 << cmd->segment;
+    }
+    else
+    {
+        u8 mapping[TIC_PALETTE_SIZE];
+        drawSprite(machine, &machine->state.clip, memory->ram.vram.blit.segment, index, x, y, w, h, getPalette(memory, colors, count, mapping), scale, flip, rotate);
+    }
 }
 
-static inline u8* getFlag(tic_mem* memory, s32 index, u8 flag)
+static inline bool isFlag(s32 index, u8 flag)
 {
-    static u8 stub = 0;
-    if(index >= TIC_FLAGS || flag >= BITS_IN_BYTE)
-        return &stub;
-
-    return memory->ram.flags.data + index;
+    return index >= 0 && index < TIC_FLAGS && flag < BITS_IN_BYTE;
 }
 
 bool tic_api_fget(tic_mem* memory, s32 index, u8 flag)
 {
-    return *getFlag(memory, index, flag) & (1 << flag);
+    return isFlag(index, flag) && (getSyncSection((tic_machine*)memory, SyncFlags)[index] & (1 << flag));
 }
 
 void tic_api_fset(tic_mem* memory, s32 index, u8 flag, bool value)
 {
+    if(!isFlag(index, flag)) return;
+
+    loadSyncSections((tic_machine*)memory, offsetof(tic_ram, flags), sizeof(tic_flags), false);
+    u8* flags = memory->ram.flags.data + index;
+
     if(value)
-        *getFlag(memory, index, flag) |= (1 << flag);
+        *flags |= (1 << flag);
     else 
-        *getFlag(memory, index, flag) &= ~(1 << flag);
+        *flags &= ~(1 << flag);
 }
 
 u8 tic_api_pix(tic_mem* memory, s32 x, s32 y, u8 color, bool get)
 {
     tic_machine* machine = (tic_machine*)memory;
 
+    flushDeferred(machine);
+
     if(get) return getPixel(machine, x, y);
 
-    setPixel(machine, x, y, mapColor(memory, color));
+    setPixel(machine, &machine->state.clip, x, y, mapColor(memory, color));
     return 0;
 }
 
@@ -838,64 +1583,49 @@ void tic_api_rectb(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, u8 colo
 {
     tic_machine* machine = (tic_machine*)memory;
 
-    drawRectBorder(machine, x, y, width, height, mapColor(memory, color));
+    flushDeferred(machine);
+
+    drawRectBorder(machine, &machine->state.clip, x, y, width, height, mapColor(memory, color));
 }
 
-static struct
+typedef struct
 {
     s16 Left[TIC80_HEIGHT];
     s16 Right[TIC80_HEIGHT];    
-    s32 ULeft[TIC80_HEIGHT];
-    s32 VLeft[TIC80_HEIGHT];
 } SidesBuffer;
 
-static void initSidesBuffer()
+static void initSidesBuffer(SidesBuffer* sides)
 {
-    for(s32 i = 0; i < COUNT_OF(SidesBuffer.Left); i++)
-        SidesBuffer.Left[i] = TIC80_WIDTH, SidesBuffer.Right[i] = -1;   
+    for(s32 i = 0; i < COUNT_OF(sides->Left); i++)
+        sides->Left[i] = TIC80_WIDTH, sides->Right[i] = -1;   
 }
 
-static void setSidePixel(s32 x, s32 y)
+static void setSidePixel(SidesBuffer* sides, s32 x, s32 y)
 {
     if(y >= 0 && y < TIC80_HEIGHT)
     {
-        if(x < SidesBuffer.Left[y]) SidesBuffer.Left[y] = x;
-        if(x > SidesBuffer.Right[y]) SidesBuffer.Right[y] = x;
-    }
-}
-
-static void setSideTexPixel(s32 x, s32 y, float u, float v)
-{
-    s32 yy = y;
-    if (yy >= 0 && yy < TIC80_HEIGHT)
-    {
-        if (x < SidesBuffer.Left[yy])
-        {
-            SidesBuffer.Left[yy] = x;
-            SidesBuffer.ULeft[yy] = u*65536.0f;
-            SidesBuffer.VLeft[yy] = v*65536.0f;
-        }
-        if (x > SidesBuffer.Right[yy])
-        {
-            SidesBuffer.Right[yy] = x;
-        }
+        if(x < sides->Left[y]) sides->Left[y] = x;
+        if(x > sides->Right[y]) sides->Right[y] = x;
     }
 }
 
 void tic_api_circ(tic_mem* memory, s32 xm, s32 ym, s32 radius, u8 color)
 {
     tic_machine* machine = (tic_machine*)memory;
+    SidesBuffer sides;
+
+    flushDeferred(machine);
 
-    initSidesBuffer();
+    initSidesBuffer(&sides);
 
     s32 r = radius;
     s32 x = -r, y = 0, err = 2-2*r;
     do 
     {
-        setSidePixel(xm-x, ym+y);
-        setSidePixel(xm-y, ym-x);
-        setSidePixel(xm+x, ym-y);
-        setSidePixel(xm+y, ym+x);
+        setSidePixel(&sides, xm-x, ym+y);
+        setSidePixel(&sides, xm-y, ym-x);
+        setSidePixel(&sides, xm+x, ym-y);
+        setSidePixel(&sides, xm+y, ym+x);
 
         r = err;
         if (r <= y) err += ++y*2+1;
@@ -906,8 +1636,8 @@ void tic_api_circ(tic_mem* memory, s32 xm, s32 ym, s32 radius, u8 color)
     s32 yb = MIN(machine->state.clip.b, ym+radius+1);
     u8 final_color = mapColor(&machine->memory, color);
     for(s32 y = yt; y < yb; y++) {
-        s32 xl = MAX(SidesBuffer.Left[y], machine->state.clip.l);
-        s32 xr = MIN(SidesBuffer.Right[y]+1, machine->state.clip.r);
+        s32 xl = MAX(sides.Left[y], machine->state.clip.l);
+        s32 xr = MIN(sides.Right[y]+1, machine->state.clip.r);
         machine->state.drawhline(&machine->memory, xl, xr, y, final_color);
     }
 }
@@ -915,22 +1645,436 @@ void tic_api_circ(tic_mem* memory, s32 xm, s32 ym, s32 radius, u8 color)
 void tic_api_circb(tic_mem* memory, s32 xm, s32 ym, s32 radius, u8 color)
 {
     tic_machine* machine = (tic_machine*)memory;
+    const tic_clip_data* clip = &machine->state.clip;
+
+    flushDeferred(machine);
+
+    // the outline is skipped when it misses the clip rect and drawn unclipped when it lies inside
+    bool inside = false;
+    if(radius >= 0)
+    {
+        if(xm + radius < clip->l || xm - radius >= clip->r || ym + radius < clip->t || ym - radius >= clip->b)
+            return;
+
+        inside = xm - radius >= clip->l && xm + radius < clip->r && ym - radius >= clip->t && ym + radius < clip->b;
+    }
+
     u8 final_color = mapColor(memory, color);
     s32 r = radius;
     s32 x = -r, y = 0, err = 2-2*r;
     do {
-        setPixel(machine, xm-x, ym+y, final_color);
-        setPixel(machine, xm-y, ym-x, final_color);
-        setPixel(machine, xm+x, ym-y, final_color);
-        setPixel(machine, xm+y, ym+x, final_color);
+        if(inside)
+        {
+            machine->state.setpix(memory, xm-x, ym+y, final_color);
+            machine->state.setpix(memory, xm-y, ym-x, final_color);
+            machine->state.setpix(memory, xm+x, ym-y, final_color);
+            machine->state.setpix(memory, xm+y, ym+x, final_color);
+        }
+        else
+        {
+            setPixel(machine, clip, xm-x, ym+y, final_color);
+            setPixel(machine, clip, xm-y, ym-x, final_color);
+            setPixel(machine, clip, xm+x, ym-y, final_color);
+            setPixel(machine, clip, xm+y, ym+x, final_color);
+        }
         r = err;
         if (r <= y) err += ++y*2+1;
         if (r > x || err > y) err += ++x*2+1;
     } while (x < 0);
 }
 
-typedef void(*linePixelFunc)(tic_mem* memory, s32 x, s32 y, u8 color);
-static void ticLine(tic_mem* memory, s32 x0, s32 y0, s32 x1, s32 y1, u8 color, linePixelFunc func)
+typedef void(*linePixelFunc)(void* data, s32 x, s32 y, u8 color);
+static void ticLine(void* data, s32 x0, s32 y0, s32 x1, s32 y1, u8 color, linePixelFunc func)
+{
+    if(y0 > y1)
+    {
+        SWAP(x0, x1, s32);
+        SWAP(y0, y1, s32);
+    }
+
+    s32 dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    s32 dy = y1 - y0; 
+    s32 err = (dx > dy ? dx : -dy) / 2, e2;
+
+    for(;;)
+    {
+        func(data, x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        e2 = err;
+        if (e2 >-dx) { err -= dy; x0 += sx; }
+        if (e2 < dy) { err += dx; y0++; }
+    }
+}
+
+static void triPixelFunc(void* data, s32 x, s32 y, u8 color)
+{
+    setSidePixel(data, x, y);
+}
+
+static void drawTri(tic_machine* machine, const tic_clip_data* clip, s32 x1, s32 y1, s32 x2, s32 y2, s32 x3, s32 y3, u8 color)
+{
+    SidesBuffer sides;
+
+    initSidesBuffer(&sides);
+
+    ticLine(&sides, x1, y1, x2, y2, color, triPixelFunc);
+    ticLine(&sides, x2, y2, x3, y3, color, triPixelFunc);
+    ticLine(&sides, x3, y3, x1, y1, color, triPixelFunc);
+
+    s32 yt = MAX(clip->t, MIN(y1, MIN(y2, y3)));
+    s32 yb = MIN(clip->b, MAX(y1, MAX(y2, y3)) + 1);
+
+    for(s32 y = yt; y < yb; y++) {
+        s32 xl = MAX(sides.Left[y], clip->l);
+        s32 xr = MIN(sides.Right[y]+1, clip->r);
+        machine->state.drawhline(&machine->memory, xl, xr, y, color);
+    }
+}
+
+void tic_api_tri(tic_mem* memory, s32 x1, s32 y1, s32 x2, s32 y2, s32 x3, s32 y3, u8 color)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    DeferredCommand* cmd = addDeferred(machine, DeferredTri, MIN(y1, MIN(y2, y3)), MAX(y1, MAX(y2, y3)) + 1, 0);
+
+    if(cmd)
+    {
+        cmd->tri.x1 = x1;
+        cmd->tri.y1 = y1;
+        cmd->tri.x2 = x2;
+        cmd->tri.y2 = y2;
+        cmd->tri.x3 = x3;
+        cmd->tri.y3 = y3;
+        cmd->tri.color = mapColor(memory, color);
+    }
+    else drawTri(machine, &machine->state.clip, x1, y1, x2, y2, x3, y3, mapColor(memory, color));
+}
+
+
+typedef struct
+{
+    float x, y, u, v;
+} TexVert;
+
+typedef struct
+{
+    s32 left[TIC80_HEIGHT];
+    s32 right[TIC80_HEIGHT];
+    s32 u[TIC80_HEIGHT];
+    s32 v[TIC80_HEIGHT];
+} TexSides;
+
+typedef struct
+{
+    tic_machine* machine;
+    const tic_clip_data* clip;
+    tic_tilesheet sheet;
+    const u8* mapping;
+    bool use_map;
+
+    // pixels of the last fetched tile and its cell, tiles out of the cache are decoded into scratch
+    const u8* pixels;
+    s32 cellx;
+    s32 celly;
+    u8 scratch[TIC_SPRITESIZE * TIC_SPRITESIZE];
+
+    TexSides sides;
+} TexContext;
+
+// walks an edge in 16.16 fixed point, only rows inside [top, bottom) are stored
+static void ticTexLine(TexSides* sides, const TexVert* v0, const TexVert* v1, s32 top, s32 bottom)
+{
+    const TexVert* t = v0->y > v1->y ? v1 : v0;
+    const TexVert* b = v0->y > v1->y ? v0 : v1;
+
+    float dy = b->y - t->y;
+    float step_x = b->x - t->x;
+    float step_u = b->u - t->u;
+    float step_v = b->v - t->v;
+
+    if ((s32)dy != 0)
+    {
+        step_x /= dy;
+        step_u /= dy;
+        step_v /= dy;
+    }
+
+    // edges above the screen start at y=0, others keep their fraction
+    float skip = MAX(-t->y, .0f);
+    s32 row = (s32)(t->y + skip);
+    s32 end = MIN((s32)b->y, bottom);
+
+    if(MAX(row, top) >= end) return;
+
+    // x is 64 bit to keep far off screen vertices from overflowing
+    s64 x = (t->x + step_x * skip) * 65536.0f;
+    s32 u = (t->u + step_u * skip) * 65536.0f;
+    s32 v = (t->v + step_v * skip) * 65536.0f;
+    s64 dx = step_x * 65536.0f;
+    s32 du = step_u * 65536.0f;
+    s32 dv = step_v * 65536.0f;
+
+    // skips whole rows, so an edge lands on the same pixels whatever the clip is
+    if(row < top)
+    {
+        s32 rows = top - row;
+
+        x += dx * rows;
+        u += (s32)((s64)du * rows);
+        v += (s32)((s64)dv * rows);
+        row = top;
+    }
+
+    for(; row < end; row++, x += dx, u += du, v += dv)
+    {
+        // rounds towards zero as the float walk did
+        s32 px = (s32)(x / 65536);
+
+        if(px < sides->left[row])
+        {
+            sides->left[row] = px;
+            sides->u[row] = u;
+            sides->v[row] = v;
+        }
+
+        if(px > sides->right[row])
+            sides->right[row] = px;
+    }
+}
+
+static inline const u8* getTexTile(TexContext* ctx, s32 cellx, s32 celly)
+{
+    if(ctx->pixels && cellx == ctx->cellx && celly == ctx->celly)
+        return ctx->pixels;
+
+    tic_tileptr tile;
+    if(ctx->use_map)
+    {
+        u8 index = getSyncMap(ctx->machine)->data[celly * TIC_MAP_WIDTH + cellx];
+        tile = getTile(&ctx->sheet, index, true);
+    }
+    else
+    {
+        // same addressing as getTileSheetPixel, one cached tile per 8x8 cell
+        const tic_blit_segment* segment = ctx->sheet.segment;
+        s32 x = cellx * TIC_SPRITESIZE;
+        u32 index = (celly << 4) + x / segment->tile_width;
+        u32 offset = index * segment->ptr_size;
+        const u8* ptr = ctx->sheet.ptr + offset;
+
+        // the last cells run past the sprites into the map, which sync may have left in another bank
+        enum {SheetSize = sizeof(tic_tiles) * TIC_SPRITE_BANKS};
+        if(offset >= SheetSize && ctx->sheet.ptr == getSyncSection(ctx->machine, SyncTiles))
+            ptr = getSyncMap(ctx->machine)->data + (offset - SheetSize);
+
+        tile = (tic_tileptr){segment, x & (segment->tile_width - 1), (u8*)ptr};
+    }
+
+    ctx->cellx = cellx;
+    ctx->celly = celly;
+    return ctx->pixels = getTileCachePixels(&ctx->machine->tilecache, &tile, ctx->scratch);
+}
+
+static void drawTexturedTriangle(TexContext* ctx, const float* pt)
+{
+    tic_machine* machine = ctx->machine;
+    TexSides* sides = &ctx->sides;
+    TexVert V0 = {pt[0], pt[1], pt[6], pt[7]};
+    TexVert V1 = {pt[2], pt[3], pt[8], pt[9]};
+    TexVert V2 = {pt[4], pt[5], pt[10], pt[11]};
+
+    //  calculate the slope of the surface 
+    //  use floats here 
+    double denom = (V0.x - V2.x) * (V1.y - V2.y) - (V1.x - V2.x) * (V0.y - V2.y);
+    if (denom == 0.0)
+    {
+        return;
+    }
+    double id = 1.0 / denom;
+    float dudx, dvdx;
+    //  this is the UV slope across the surface
+    dudx = ((V0.u - V2.u) * (V1.y - V2.y) - (V1.u - V2.u) * (V0.y - V2.y)) * id;
+    dvdx = ((V0.v - V2.v) * (V1.y - V2.y) - (V1.v - V2.v) * (V0.y - V2.y)) * id;
+    //  convert to fixed
+    s32 dudxs = dudx * 65536.0f;
+    s32 dvdxs = dvdx * 65536.0f;
+
+    //  only the rows inside of the clip rect are walked, [clip.t, clip.b) like every other primitive;
+    //  the old loop let row clip.b through but setPixel dropped it, so the same rows are drawn
+    const tic_clip_data* clip = ctx->clip;
+    s32 top = clip->t;
+    s32 bottom = clip->b;
+
+    float ymin = MIN(V0.y, MIN(V1.y, V2.y));
+    float ymax = MAX(V0.y, MAX(V1.y, V2.y));
+
+    if(ymin > top) top = MIN((s32)ymin, bottom);
+    if(ymax < bottom) bottom = MAX((s32)ymax, top);
+
+    for(s32 y = top; y < bottom; y++)
+        sides->left[y] = TIC80_WIDTH, sides->right[y] = -1;
+
+    ticTexLine(sides, &V0, &V1, top, bottom);
+    ticTexLine(sides, &V1, &V2, top, bottom);
+    ticTexLine(sides, &V2, &V0, top, bottom);
+
+    for (s32 y = top; y < bottom; y++)
+    {
+        //  if it's backwards skip it
+        if(sides->right[y] <= sides->left[y])
+            continue;
+
+        s32 u = sides->u[y];
+        s32 v = sides->v[y];
+        s32 left = sides->left[y];
+        s32 right = MIN(sides->right[y], clip->r);
+
+        //  offset UV's if we are off the left 
+        if (left < clip->l)
+        {
+            s32 dist = clip->l - left;
+            u += dudxs * dist;
+            v += dvdxs * dist;
+            left = clip->l;
+        }
+
+        if(left >= right)
+            continue;
+
+        u8 row[TIC80_WIDTH];
+        u8* dst = row;
+
+        if (ctx->use_map)
+        {
+            enum { MapWidth = TIC_MAP_WIDTH * TIC_SPRITESIZE, MapHeight = TIC_MAP_HEIGHT * TIC_SPRITESIZE };
+
+            for (s32 x = left; x < right; ++x, u += dudxs, v += dvdxs)
+            {
+                s32 iu = (u >> 16) % MapWidth;
+                s32 iv = (v >> 16) % MapHeight;
+
+                if (iu < 0) iu += MapWidth;
+                if (iv < 0) iv += MapHeight;
+
+                const u8* pixels = getTexTile(ctx, iu >> 3, iv >> 3);
+                *dst++ = ctx->mapping[pixels[(iv & 7) * TIC_SPRITESIZE + (iu & 7)]];
+            }
+        }
+        else
+        {
+            enum{SheetWidth = TIC_SPRITESHEET_SIZE, SheetHeight = TIC_SPRITESHEET_SIZE * TIC_SPRITE_BANKS};
+
+            for (s32 x = left; x < right; ++x, u += dudxs, v += dvdxs)
+            {
+                s32 iu = (u >> 16) & (SheetWidth - 1);
+                s32 iv = (v >> 16) & (SheetHeight - 1);
+
+                const u8* pixels = getTexTile(ctx, iu >> 3, iv >> 3);
+                *dst++ = ctx->mapping[pixels[(iv & 7) * TIC_SPRITESIZE + (iu & 7)]];
+            }
+        }
+
+        machine->state.drawspan(&machine->memory, row, left, y, right - left);
+    }
+}
+
+static void drawTexturedTriangles(tic_machine* machine, const tic_clip_data* clip, u8 segment, const float* triangles, s32 count, bool use_map, const u8* mapping)
+{
+    TexContext ctx;
+    ctx.machine = machine;
+    ctx.clip = clip;
+    ctx.sheet = getTileSheetFromSegment(&machine->memory, segment);
+    ctx.mapping = mapping;
+    ctx.use_map = use_map;
+    ctx.pixels = NULL;
+
+    for(s32 i = 0; i < count; i++, triangles += TIC_TEXTRI_FLOATS)
+        drawTexturedTriangle(&ctx, triangles);
+}
+
+void tic_api_textri_list(tic_mem* memory, const float* triangles, s32 count, bool use_map, u8* colors, s32 chroma)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    s32 size = count * TIC_TEXTRI_FLOATS * sizeof(float);
+    DeferredCommand* cmd = count > 0 ? addDeferred(machine, DeferredTextri, INT32_MIN, INT32_MAX, size) : NULL;
+
+    if(cmd)
+    {
+        cmd->textri.count = count;
+        cmd->textri.use_map = use_map;
+        getPalette(memory, colors, chroma, cmd->textri.mapping);
+        memcpy(cmd + 1, triangles, size);
+        machine->deferred.segments |= 1 << cmd->segment;
+    }
+    else
+    {
+        u8 mapping[TIC_PALETTE_SIZE];
+        drawTexturedTriangles(machine, &machine->state.clip, memory->ram.vram.blit.segment, triangles, count, use_map, getPalette(memory, colors, chroma, mapping));
+    }
+}
+
+void tic_api_textri(tic_mem* memory, float x1, float y1, float x2, float y2, float x3, float y3, float u1, float v1, float u2, float v2, float u3, float v3, bool use_map, u8* colors, s32 count)
+{
+    const float pt[TIC_TEXTRI_FLOATS] = {x1, y1, x2, y2, x3, y3, u1, v1, u2, v2, u3, v3};
+    tic_api_textri_list(memory, pt, 1, use_map, colors, count);
+}
+
+void tic_api_map(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, u8* colors, s32 count, s32 scale, RemapFunc remap, void* data)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    s32 size = height * TIC_SPRITESIZE * scale;
+
+    // remap calls back into the script, so it is never deferred
+    DeferredCommand* cmd = remap || scale <= 0 || count > TIC_PALETTE_SIZE ? NULL
+        : addDeferred(machine, DeferredMap, MIN(sy, sy + size), MAX(sy, sy + size), 0);
+
+    if(cmd)
+    {
+        cmd->map.x = x;
+        cmd->map.y = y;
+        cmd->map.width = width;
+        cmd->map.height = height;
+        cmd->map.sx = sx;
+        cmd->map.sy = sy;
+        cmd->map.scale = scale;
+        cmd->map.count = count;
+        if(count) memcpy(cmd->map.colors, colors, count);
+        machine->deferred.segments |= 1 << cmd->segment;
+    }
+    else
+    {
+        flushDeferred(machine);
+
+        // remap runs script code, which may write the sheet or the map while they're drawn
+        if(remap)
+            loadSyncSections(machine, offsetof(tic_ram, tiles), offsetof(tic_ram, map) + sizeof(tic_map) - offsetof(tic_ram, tiles), false);
+
+        drawMap(machine, &machine->state.clip, memory->ram.vram.blit.segment, getSyncMap(machine), x, y, width, height, sx, sy, colors, count, scale, remap, data);
+    }
+}
+
+void tic_api_mset(tic_mem* memory, s32 x, s32 y, u8 value)
+{
+    if(x < 0 || x >= TIC_MAP_WIDTH || y < 0 || y >= TIC_MAP_HEIGHT) return;
+
+    flushDeferred((tic_machine*)memory);
+    loadSyncSections((tic_machine*)memory, offsetof(tic_ram, map), sizeof(tic_map), false);
+
+    tic_map* src = &memory->ram.map;
+    *(src->data + y * TIC_MAP_WIDTH + x) = value;
+}
+
+u8 tic_api_mget(tic_mem* memory, s32 x, s32 y)
+{
+    if(x < 0 || x >= TIC_MAP_WIDTH || y < 0 || y >= TIC_MAP_HEIGHT) return 0;
+    
+    const tic_map* src = getSyncMap((tic_machine*)memory);
+    return *(src->data + y * TIC_MAP_WIDTH + x);
+}
+
+// draws the same pixels as ticLine, but only walks the steps inside the clip rect:
+// the error term stays in [0, dx) for x major lines and in (-dy, 0] for y major ones,
+// so the minor coordinate of any step can be computed directly
+static void drawLine(tic_machine* machine, const tic_clip_data* clip, s32 x0, s32 y0, s32 x1, s32 y1, u8 color)
 {
     if(y0 > y1)
     {
@@ -938,258 +2082,277 @@ static void ticLine(tic_mem* memory, s32 x0, s32 y0, s32 x1, s32 y1, u8 color, l
         SWAP(y0, y1, s32);
     }
 
-    s32 dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-    s32 dy = y1 - y0; 
-    s32 err = (dx > dy ? dx : -dy) / 2, e2;
+    if(y1 < clip->t || y0 >= clip->b || MAX(x0, x1) < clip->l || MIN(x0, x1) >= clip->r) return;
 
-    for(;;)
+    const s64 dx = x0 < x1 ? (s64)x1 - x0 : (s64)x0 - x1;
+    const s64 dy = (s64)y1 - y0;
+    const s32 sx = x0 < x1 ? 1 : -1;
+
+    if(dx > dy)
     {
-        func(memory, x0, y0, color);
-        if (x0 == x1 && y0 == y1) break;
-        e2 = err;
-        if (e2 >-dx) { err -= dy; x0 += sx; }
-        if (e2 < dy) { err += dx; y0++; }
-    }
-}
+        // x moves every step, consecutive pixels of a row are drawn as one span
+        s64 first = MAX(0, sx > 0 ? (s64)clip->l - x0 : (s64)x0 - (clip->r - 1));
+        s64 last = MIN(dx, sx > 0 ? (s64)clip->r - 1 - x0 : (s64)x0 - clip->l);
 
-static void triPixelFunc(tic_mem* memory, s32 x, s32 y, u8 color)
-{
-    setSidePixel(x, y);
-}
+        s64 row = (first * dy - dx / 2 + dx - 1) / dx;
+        s64 err = dx / 2 - first * dy + row * dx;
 
-void tic_api_tri(tic_mem* memory, s32 x1, s32 y1, s32 x2, s32 y2, s32 x3, s32 y3, u8 color)
-{
-    tic_machine* machine = (tic_machine*)memory;
+        s32 x = x0 + sx * (s32)first;
+        s32 y = y0 + (s32)row;
+        s32 from = x;
 
-    initSidesBuffer();
+        for(s64 k = first; k <= last; k++, x += sx)
+        {
+            bool step = err < dy;
 
-    ticLine(memory, x1, y1, x2, y2, color, triPixelFunc);
-    ticLine(memory, x2, y2, x3, y3, color, triPixelFunc);
-    ticLine(memory, x3, y3, x1, y1, color, triPixelFunc);
+            err -= dy;
+            if(step) err += dx;
 
-    u8 final_color = mapColor(&machine->memory, color);
-    s32 yt = MAX(machine->state.clip.t, MIN(y1, MIN(y2, y3)));
-    s32 yb = MIN(machine->state.clip.b, MAX(y1, MAX(y2, y3)) + 1);
+            if(step || k == last)
+            {
+                if(y >= clip->t && y < clip->b)
+                    machine->state.drawhline(&machine->memory, MIN(from, x), MAX(from, x) + 1, y, color);
 
-    for(s32 y = yt; y < yb; y++) {
-        s32 xl = MAX(SidesBuffer.Left[y], machine->state.clip.l);
-        s32 xr = MIN(SidesBuffer.Right[y]+1, machine->state.clip.r);
-        machine->state.drawhline(&machine->memory, xl, xr, y, final_color);
+                from = x + sx;
+            }
+
+            if(step && ++y >= clip->b) break;
+        }
     }
-}
+    else if(dy == 0)
+        setPixel(machine, clip, x0, y0, color);
+    else
+    {
+        // y moves every step, vertical lines never leave the clipped column
+        s64 first = MAX(0, (s64)clip->t - y0);
+        s64 last = MIN(dy, (s64)clip->b - 1 - y0);
 
+        s64 col = (first * dx - dy / 2 + dy - 1) / dy;
+        s64 err = -(dy / 2) + first * dx - col * dy;
 
-typedef struct
-{
-    float x, y, u, v;
-} TexVert;
+        s32 x = x0 + sx * (s32)col;
 
+        for(s32 y = y0 + (s32)first, end = y0 + (s32)last; y <= end; y++)
+        {
+            if(x >= clip->l && x < clip->r)
+                machine->state.setpix(&machine->memory, x, y, color);
 
-static void ticTexLine(tic_mem* memory, TexVert *v0, TexVert *v1)
-{
-    TexVert *top = v0;
-    TexVert *bot = v1;
+            if(err > -dx)
+            {
+                err -= dy;
+                x += sx;
+            }
 
-    if (bot->y < top->y)
-    {
-        top = v1;
-        bot = v0;
+            err += dx;
+        }
     }
+}
 
-    float dy = bot->y - top->y;
-    float step_x = (bot->x - top->x);
-    float step_u = (bot->u - top->u);
-    float step_v = (bot->v - top->v);
+void tic_api_line(tic_mem* memory, s32 x0, s32 y0, s32 x1, s32 y1, u8 color)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    DeferredCommand* cmd = addDeferred(machine, DeferredLine, MIN(y0, y1), MAX(y0, y1) + 1, 0);
 
-    if ((s32)dy != 0)
+    if(cmd)
     {
-        step_x /= dy;
-        step_u /= dy;
-        step_v /= dy;
+        cmd->line.x0 = x0;
+        cmd->line.y0 = y0;
+        cmd->line.x1 = x1;
+        cmd->line.y1 = y1;
+        cmd->line.color = mapColor(memory, color);
     }
+    else drawLine(machine, &machine->state.clip, x0, y0, x1, y1, mapColor(memory, color));
+}
 
-    float x = top->x;
-    float y = top->y;
-    float u = top->u;
-    float v = top->v;
-
-    if(y < .0f)
+static void drawDeferred(tic_machine* machine, const DeferredCommand* cmd, const tic_clip_data* clip)
+{
+    switch(cmd->type)
     {
-        y = .0f - y;
-
-        x += step_x * y;
-        u += step_u * y;
-        v += step_v * y;
+    case DeferredCls:
+        {
+            u8 color = cmd->cls.color;
+            s32 rows = clip->b - clip->t;
 
-        y = .0f;
-    }
+            if(machine->shadow.enabled)
+                memset(machine->shadow.pixels + clip->t * TIC80_WIDTH, color, rows * TIC80_WIDTH);
+            else
+                memset(machine->memory.ram.vram.screen.data + clip->t * TIC80_WIDTH / 2, color | (color << TIC_PALETTE_BPP), rows * TIC80_WIDTH / 2);
 
-    s32 botY = bot->y;
-    if(botY > TIC80_HEIGHT)
-        botY = TIC80_HEIGHT;
+            setScreenRowsDirty(machine, clip->t, clip->b);
+        }
+        break;
+    case DeferredRect:
+        drawRect(machine, clip, cmd->rect.x, cmd->rect.y, cmd->rect.width, cmd->rect.height, cmd->rect.color);
+        break;
+    case DeferredLine:
+        drawLine(machine, clip, cmd->line.x0, cmd->line.y0, cmd->line.x1, cmd->line.y1, cmd->line.color);
+        break;
+    case DeferredTri:
+        drawTri(machine, clip, cmd->tri.x1, cmd->tri.y1, cmd->tri.x2, cmd->tri.y2, cmd->tri.x3, cmd->tri.y3, cmd->tri.color);
+        break;
+    case DeferredTextri:
+        drawTexturedTriangles(machine, clip, cmd->segment, (const float*)(cmd + 1), cmd->textri.count, cmd->textri.use_map, cmd->textri.mapping);
+        break;
+    case DeferredSpr:
+        drawSprite(machine, clip, cmd->segment, cmd->spr.index, cmd->spr.x, cmd->spr.y, cmd->spr.w, cmd->spr.h, 
+            cmd->spr.mapping, cmd->spr.scale, cmd->spr.flip, cmd->spr.rotate);
+        break;
+    case DeferredMap:
+        drawMap(machine, clip, cmd->segment, getSyncMap(machine), cmd->map.x, cmd->map.y, cmd->map.width, cmd->map.height, 
+            cmd->map.sx, cmd->map.sy, cmd->map.colors, cmd->map.count, cmd->map.scale, NULL, NULL);
+        break;
+    case DeferredPrint:
+        {
+            u8 mapping[] = {255, cmd->print.color};
+            tic_tilesheet font_face = getTileSheetFromSegment(&machine->memory, 1);
 
-    for (; y <botY; ++y)
-    {
-        setSideTexPixel(x, y, u, v);
-        x += step_x;
-        u += step_u;
-        v += step_v;
+            drawText(machine, clip, &font_face, (const char*)(cmd + 1), cmd->print.x, cmd->print.y, 
+                cmd->print.width, TIC_FONT_HEIGHT, cmd->print.fixed, mapping, cmd->print.scale, cmd->print.alt);
+        }
+        break;
     }
 }
 
-static void drawTexturedTriangle(tic_machine* machine, float x1, float y1, float x2, float y2, float x3, float y3, float u1, float v1, float u2, float v2, float u3, float v3, bool use_map, u8* colors, s32 count)
+static void drawDeferredBand(void* data, s32 band)
 {
-    tic_mem* memory = &machine->memory;
-    u8* mapping = getPalette(memory, colors, count);
-    TexVert V0, V1, V2;
+    tic_machine* machine = data;
+    s32 top = band * TIC80_HEIGHT / machine->deferred.bands;
+    s32 bottom = (band + 1) * TIC80_HEIGHT / machine->deferred.bands;
 
-    const u8* map = memory->ram.map.data;
-    tic_tilesheet sheet = getTileSheetFromSegment(memory, memory->ram.vram.blit.segment);
+    for(s32 offset = 0; offset < machine->deferred.size;)
+    {
+        const DeferredCommand* cmd = (const DeferredCommand*)(machine->deferred.data + offset);
+        offset += cmd->size;
 
-    V0.x = x1;  V0.y = y1;  V0.u = u1;  V0.v = v1;
-    V1.x = x2;  V1.y = y2;  V1.u = u2;  V1.v = v2;
-    V2.x = x3;  V2.y = y3;  V2.u = u3;  V2.v = v3;
+        if(cmd->bottom <= top || cmd->top >= bottom) continue;
 
-    //  calculate the slope of the surface 
-    //  use floats here 
-    double denom = (V0.x - V2.x) * (V1.y - V2.y) - (V1.x - V2.x) * (V0.y - V2.y);
-    if (denom == 0.0)
-    {
-        return;
+        tic_clip_data clip = {cmd->clip.l, MAX(cmd->clip.t, top), cmd->clip.r, MIN(cmd->clip.b, bottom)};
+        drawDeferred(machine, cmd, &clip);
     }
-    double id = 1.0 / denom;
-    float dudx, dvdx;
-    //  this is the UV slope across the surface
-    dudx = ((V0.u - V2.u) * (V1.y - V2.y) - (V1.u - V2.u) * (V0.y - V2.y)) * id;
-    dvdx = ((V0.v - V2.v) * (V1.y - V2.y) - (V1.v - V2.v) * (V0.y - V2.y)) * id;
-    //  convert to fixed
-    s32 dudxs = dudx * 65536.0f;
-    s32 dvdxs = dvdx * 65536.0f;
-    //  fill the buffer 
-    initSidesBuffer();
-    //  parse each line and decide where in the buffer to store them ( left or right ) 
-    ticTexLine(memory, &V0, &V1);
-    ticTexLine(memory, &V1, &V2);
-    ticTexLine(memory, &V2, &V0);
+}
 
-    for (s32 y = 0; y < TIC80_HEIGHT; y++)
-    {
-        //  if it's backwards skip it
-        s32 width = SidesBuffer.Right[y] - SidesBuffer.Left[y];
-        //  if it's off top or bottom , skip this line
-        if ((y < machine->state.clip.t) || (y > machine->state.clip.b))
-            width = 0;
-        if (width > 0)
-        {
-            s32 u = SidesBuffer.ULeft[y];
-            s32 v = SidesBuffer.VLeft[y];
-            s32 left = SidesBuffer.Left[y];
-            s32 right = SidesBuffer.Right[y];
-            //  check right edge, and CLAMP it
-            if (right > machine->state.clip.r)
-                right = machine->state.clip.r;
-            //  check left edge and offset UV's if we are off the left 
-            if (left < machine->state.clip.l)
-            {
-                s32 dist = machine->state.clip.l - SidesBuffer.Left[y];
-                u += dudxs * dist;
-                v += dvdxs * dist;
-                left = machine->state.clip.l;
-            }
-            //  are we drawing from the map . ok then at least check before the inner loop
-            if (use_map == true)
-            {
-                for (s32 x = left; x < right; ++x)
-                {
-                    enum { MapWidth = TIC_MAP_WIDTH * TIC_SPRITESIZE, MapHeight = TIC_MAP_HEIGHT * TIC_SPRITESIZE };
-                    s32 iu = (u >> 16) % MapWidth;
-                    s32 iv = (v >> 16) % MapHeight;
+// replays the recorded calls, every band runs all of them over its own rows
+static void flushDeferred(tic_machine* machine)
+{
+    if(machine->deferred.size == 0) return;
 
-                    while (iu < 0) iu += MapWidth;
-                    while (iv < 0) iv += MapHeight;
+    tic_jobs* jobs = machine->deferred.jobs;
 
-                    u8 tileindex = map[(iv >> 3) * TIC_MAP_WIDTH + (iu >> 3)];
-                    tic_tileptr tile = getTile(&sheet, tileindex, true);
+    // workers share the decoded tiles read only, they can't decode them lazily
+    for(s32 segment = 0; segment < BITS_IN_BYTE * (s32)sizeof machine->deferred.segments; segment++)
+    {
+        if(machine->deferred.segments & (1 << segment))
+        {
+            tic_tilesheet sheet = getTileSheetFromSegment(&machine->memory, segment);
 
-                    u8 color = mapping[getTilePixel(&tile, iu & 7, iv & 7)];
-                    if (color != TRANSPARENT_COLOR)
-                        setPixel(machine, x, y, color);
-                    u += dudxs;
-                    v += dvdxs;
-                }
-            }
-            else
-            {
-                //  direct from tile ram 
-                for (s32 x = left; x < right; ++x)
-                {
-                    enum{SheetWidth = TIC_SPRITESHEET_SIZE, SheetHeight = TIC_SPRITESHEET_SIZE * TIC_SPRITE_BANKS};
-                    s32 iu = (u>>16) & (SheetWidth - 1);
-                    s32 iv = (v>>16) & (SheetHeight - 1);
-
-                    u8 color = mapping[getTileSheetPixel(&sheet, iu, iv)];
-                    if (color != TRANSPARENT_COLOR)
-                        setPixel(machine, x, y, color);
-                    u += dudxs;
-                    v += dvdxs;
-                }
-            }
+            if(!prepareTileCache(&machine->tilecache, sheet.segment))
+                jobs = NULL;
         }
     }
+
+    if(machine->shadow.enabled)
+        machine->shadow.dirty = true;
+
+    // a couple of bands per thread evens out the load of crowded rows
+    machine->deferred.bands = jobs ? MIN((tic_jobs_threads(jobs) + 1) * 2, TIC80_HEIGHT) : 1;
+    tic_jobs_run(jobs, drawDeferredBand, machine, machine->deferred.bands);
+
+    machine->deferred.size = 0;
+    machine->deferred.segments = 0;
 }
 
-void tic_api_textri(tic_mem* memory, float x1, float y1, float x2, float y2, float x3, float y3, float u1, float v1, float u2, float v2, float u3, float v3, bool use_map, u8* colors, s32 count)
+void tic_core_deferred(tic_mem* memory, s32 threads)
 {
-    drawTexturedTriangle((tic_machine*)memory, x1, y1, x2, y2, x3, y3, u1, v1, u2, v2, u3, v3, use_map, colors, count);
+    tic_machine* machine = (tic_machine*)memory;
+
+    flushDeferred(machine);
+    tic_jobs_close(machine->deferred.jobs);
+
+    machine->deferred.jobs = threads > 0 ? tic_jobs_create(threads) : NULL;
+    machine->deferred.active = false;
+
+    if(!machine->deferred.jobs)
+    {
+        free(machine->deferred.data);
+        machine->deferred.data = NULL;
+        machine->deferred.capacity = 0;
+    }
 }
 
-void tic_api_map(tic_mem* memory, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, u8* colors, s32 count, s32 scale, RemapFunc remap, void* data)
+void tic_core_sound(tic_mem* memory, bool enabled)
 {
-    drawMap((tic_machine*)memory, &memory->ram.map, x, y, width, height, sx, sy, colors, count, scale, remap, data);
+    tic_machine* machine = (tic_machine*)memory;
+
+    if(machine->muted == !enabled) return;
+
+    machine->muted = !enabled;
+
+    if(machine->muted)
+        memset(memory->samples.buffer, 0, memory->samples.size);
 }
 
-void tic_api_mset(tic_mem* memory, s32 x, s32 y, u8 value)
+void tic_core_share_cart(tic_mem* memory, const tic_cartridge* cart)
 {
-    if(x < 0 || x >= TIC_MAP_WIDTH || y < 0 || y >= TIC_MAP_HEIGHT) return;
+    tic_machine* machine = (tic_machine*)memory;
 
-    tic_map* src = &memory->ram.map;
-    *(src->data + y * TIC_MAP_WIDTH + x) = value;
+    // the banks sync left the sections in are about to change
+    loadSyncSections(machine, 0, sizeof(tic_ram), false);
+    freeCartBanks(machine);
+    machine->cart.written = 0;
+
+    if(cart)
+    {
+        if(!machine->cart.shared)
+            free(memory->cart);
+
+        // never written, see getCartBankWrite
+        memory->cart = (tic_cartridge*)cart;
+    }
+    else if(machine->cart.shared)
+        memory->cart = calloc(1, sizeof(tic_cartridge));
+
+    machine->cart.shared = cart != NULL;
 }
 
-u8 tic_api_mget(tic_mem* memory, s32 x, s32 y)
+// a waveform of the sfx section, decoded once until its ram is written
+static bool isNoiseWaveform(tic_machine* machine, s32 index)
 {
-    if(x < 0 || x >= TIC_MAP_WIDTH || y < 0 || y >= TIC_MAP_HEIGHT) return 0;
-    
-    const tic_map* src = &memory->ram.map;
-    return *(src->data + y * TIC_MAP_WIDTH + x);
+    if(!machine->waves.valid[index])
+    {
+        machine->waves.noise[index] = tic_tool_is_noise(&getSyncSfx(machine)->waveforms.items[index]);
+        machine->waves.valid[index] = true;
+    }
+
+    return machine->waves.noise[index];
 }
 
-static inline void setLinePixel(tic_mem* tic, s32 x, s32 y, u8 color)
+static void setWaveKind(tic_machine* machine, s32 channel, bool noise)
 {
-    setPixel((tic_machine*)tic, x, y, color);
+    machine->waves.registers.noise[channel] = noise;
+    machine->waves.registers.valid[channel] = true;
 }
 
-void tic_api_line(tic_mem* memory, s32 x0, s32 y0, s32 x1, s32 y1, u8 color)
+static bool isNoiseWave(tic_machine* machine, s32 channel)
 {
-    ticLine(memory, x0, y0, x1, y1, mapColor(memory, color), setLinePixel);
+    if(!machine->waves.registers.valid[channel])
+        setWaveKind(machine, channel, tic_tool_is_noise(&machine->memory.ram.registers[channel].waveform));
+
+    return machine->waves.registers.noise[channel];
 }
 
+// envelope position after pos ticks: it runs up to the loop end, then cycles through the loop
 static s32 calcLoopPos(const tic_sound_loop* loop, s32 pos)
 {
-    s32 offset = 0;
-
     if(loop->size > 0)
     {
-        for(s32 i = 0; i < pos; i++)
-        {
-            if(offset < (loop->start + loop->size-1))
-                offset++;
-            else offset = loop->start;
-        }
+        s32 end = loop->start + loop->size - 1;
+
+        return pos <= 0 ? 0 
+            : pos <= end ? pos 
+            : loop->start + (pos - end - 1) % loop->size;
     }
-    else offset = pos >= SFX_TICKS ? SFX_TICKS - 1 : pos;
 
-    return offset;
+    return pos >= SFX_TICKS ? SFX_TICKS - 1 : pos;
 }
 
 static void sfx(tic_mem* memory, s32 index, s32 note, s32 pitch, tic_channel_data* channel, tic_sound_register* reg, s32 channelIndex)
@@ -1205,7 +2368,7 @@ static void sfx(tic_mem* memory, s32 index, s32 note, s32 pitch, tic_channel_dat
         return;
     }
 
-    const tic_sample* effect = &memory->ram.sfx.samples.data[index];
+    const tic_sample* effect = &getSyncSfx(machine)->samples.data[index];
     s32 pos = tic_tool_sfx_pos(channel->speed, ++channel->tick);
 
     for(s32 i = 0; i < sizeof(tic_sfx_pos); i++)
@@ -1224,8 +2387,9 @@ static void sfx(tic_mem* memory, s32 index, s32 note, s32 pitch, tic_channel_dat
         reg->volume = volume;
 
         u8 wave = effect->data[channel->pos->wave].wave;
-        const tic_waveform* waveform = &memory->ram.sfx.waveforms.items[wave];
+        const tic_waveform* waveform = &getSyncSfx(machine)->waveforms.items[wave];
         memcpy(reg->waveform.data, waveform->data, sizeof(tic_waveform));
+        setWaveKind(machine, channelIndex, isNoiseWaveform(machine, wave));
 
         tic_tool_poke4(&memory->ram.stereo.data, channelIndex*2, channel->volume.left * !effect->stereo_left);
         tic_tool_poke4(&memory->ram.stereo.data, channelIndex*2+1, channel->volume.right * !effect->stereo_right);
@@ -1239,7 +2403,7 @@ static void processMusic(tic_mem* memory)
 
     if(sound_state->flag.music_state == tic_music_stop) return;
 
-    const tic_track* track = &memory->ram.music.tracks.data[sound_state->music.track];
+    const tic_track* track = &getSyncMusic(machine)->tracks.data[sound_state->music.track];
     s32 row = tick2row(track, machine->state.music.ticks);
     tic_jump_command* jumpCmd = &machine->state.music.jump;
 
@@ -1320,7 +2484,7 @@ static void processMusic(tic_mem* memory)
             s32 patternId = tic_tool_get_pattern_id(track, sound_state->music.frame, c);
             if (!patternId) continue;
 
-            const tic_track_pattern* pattern = &memory->ram.music.patterns.data[patternId - PATTERN_START];
+            const tic_track_pattern* pattern = &getSyncMusic(machine)->patterns.data[patternId - PATTERN_START];
             const tic_track_row* trackRow = &pattern->rows[sound_state->music.row];
             tic_channel_data* channel = &machine->state.music.channels[c];
             tic_command_data* cmdData = &machine->state.music.commands[c];
@@ -1453,12 +2617,14 @@ static bool isKeyPressed(const tic80_keyboard* input, tic_key key)
     return false;
 }
 
-void tic_core_tick_start(tic_mem* memory)
+// runs music and sfx of one frame into the sound registers
+static void tickSound(tic_mem* memory)
 {
     tic_machine* machine = (tic_machine*)memory;
 
-    for (s32 i = 0; i < TIC_SOUND_CHANNELS; ++i )
-        memset(&memory->ram.registers[i], 0, sizeof(tic_sound_register));
+    // registers left silent are decoded from their zeroed waveform at the end of the frame
+    memset(memory->ram.registers, 0, sizeof memory->ram.registers);
+    invalidateWaves(machine, offsetof(tic_ram, registers), sizeof memory->ram.registers);
 
     memory->ram.stereo.data = -1;
 
@@ -1471,6 +2637,13 @@ void tic_core_tick_start(tic_mem* memory)
         if(c->index >= 0)
             sfx(memory, c->index, c->note, 0, c, &memory->ram.registers[i], i);
     }
+}
+
+void tic_core_tick_start(tic_mem* memory)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    tickSound(memory);
 
     // process gamepad
     for(s32 i = 0; i < COUNT_OF(machine->state.gamepads.holds); i++)
@@ -1496,30 +2669,65 @@ void tic_core_tick_start(tic_mem* memory)
         else *hold = 0;
     }
 
-    machine->state.setpix = setPixelDma;
-    machine->state.getpix = getPixelDma;
     machine->state.synced = 0;
-    machine->state.drawhline = drawHLineDma;
+    setDrawFuncs(machine);
+
+    machine->deferred.active = machine->deferred.jobs != NULL;
 }
 
-static void stereo_tick_end(tic_mem* memory, tic_sound_register_data* registers, blip_buffer_t* blip, u8 stereoRight)
+static void synthRegisters(const tic_sound_register* registers, const bool* noise, const tic_stereo_volume* stereo, 
+    tic_sound_register_data* data, blip_buffer_t* blip, u8 stereoRight, s32 endTime)
 {
-    enum {EndTime = CLOCKRATE / TIC80_FRAMERATE};
     for (s32 i = 0; i < TIC_SOUND_CHANNELS; ++i )
     {
-        u8 volume = tic_tool_peek4(&memory->ram.stereo.data, stereoRight + i*2);
-
-        const tic_sound_register* reg = &memory->ram.registers[i];
-        tic_sound_register_data* data = registers + i;
+        u8 volume = tic_tool_peek4(&stereo->data, stereoRight + i*2);
 
-        tic_tool_is_noise(&reg->waveform)
-            ? runNoise(blip, reg, data, EndTime, volume)
-            : runEnvelope(blip, reg, data, EndTime, volume);
+        noise[i]
+            ? runNoise(blip, registers + i, data + i, endTime, volume)
+            : runEnvelope(blip, registers + i, data + i, endTime, volume);
 
-        data->time -= EndTime;
+        data[i].time -= endTime;
     }
     
-    blip_end_frame(blip, EndTime);
+    blip_end_frame(blip, endTime);
+}
+
+// synthesizes the registers of one frame into samples.buffer
+static void synthFrame(tic_machine* machine, const bool* noise)
+{
+    enum {EndTime = CLOCKRATE / TIC80_FRAMERATE};
+    tic_mem* memory = &machine->memory;
+
+    synthRegisters(memory->ram.registers, noise, &memory->ram.stereo, machine->state.registers.left, machine->blip.left, 0, EndTime);
+    synthRegisters(memory->ram.registers, noise, &memory->ram.stereo, machine->state.registers.right, machine->blip.right, 1, EndTime);
+
+    blip_read_samples(machine->blip.left, memory->samples.buffer, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+    blip_read_samples(machine->blip.right, memory->samples.buffer + 1, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+}
+
+static void queueSound(tic_machine* machine, const bool* noise)
+{
+    tic_mem* memory = &machine->memory;
+    s32 head = machine->audio.head;
+
+    // the audio thread is behind, the frame is dropped and the registers before it play on
+    if(head - tic_atomic_load(&machine->audio.tail) >= machine->audio.limit)
+        return;
+
+    tic_sound_frame* frame = &machine->audio.frames[head % TIC_SOUND_QUEUE];
+
+    memcpy(frame->registers, memory->ram.registers, sizeof frame->registers);
+    memcpy(frame->noise, noise, sizeof frame->noise);
+    frame->stereo = memory->ram.stereo;
+
+    // frames start on the sample they fall on when the rate isn't a multiple of the framerate,
+    // they're shorter while the queue plays faster than real time
+    s32 total = machine->samplerate * TIC_AUDIO_RATE + machine->audio.rest;
+    s32 length = TIC80_FRAMERATE * machine->audio.rate;
+    frame->samples = total / length;
+    machine->audio.rest = total % length;
+
+    tic_atomic_store(&machine->audio.head, head + 1);
 }
 
 void tic_core_tick_end(tic_mem* memory)
@@ -1530,15 +2738,203 @@ void tic_core_tick_end(tic_mem* memory)
     machine->state.gamepads.previous.data = input->gamepads.data;
     machine->state.keyboard.previous.data = input->keyboard.data;
 
-    stereo_tick_end(memory, machine->state.registers.left, machine->blip.left, 0);
-    stereo_tick_end(memory, machine->state.registers.right, machine->blip.right, 1);
+    if(!machine->muted)
+    {
+        bool noise[TIC_SOUND_CHANNELS];
+        for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+            noise[i] = isNoiseWave(machine, i);
+
+        if(machine->audio.limit)
+            queueSound(machine, noise);
+        else synthFrame(machine, noise);
+    }
 
-    blip_read_samples(machine->blip.left, machine->memory.samples.buffer, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
-    blip_read_samples(machine->blip.right, machine->memory.samples.buffer + 1, machine->samplerate / TIC80_FRAMERATE, TIC_STEREO_CHANNELS);
+    flushDeferred(machine);
+    machine->deferred.active = false;
 
     machine->state.setpix = setPixelOvr;
     machine->state.getpix = getPixelOvr;
     machine->state.drawhline = drawHLineOvr;
+    machine->state.drawspan = drawSpanOvr;
+}
+
+s32 tic_core_audio_thread(tic_mem* memory, s32 frames)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    s32 limit = machine->audio.limit;
+
+    machine->audio.limit = CLAMP(frames, 0, TIC_SOUND_QUEUE);
+
+    if(machine->audio.limit)
+        memset(memory->samples.buffer, 0, memory->samples.size);
+
+    return limit;
+}
+
+static void synthSound(tic_machine* machine, s16* samples, s32 count)
+{
+    const tic_sound_frame* frame = &machine->audio.current;
+    s32 clocks = blip_clocks_needed(machine->audio.blip.left, count);
+
+    synthRegisters(frame->registers, frame->noise, &frame->stereo, machine->audio.registers.left, machine->audio.blip.left, 0, clocks);
+    synthRegisters(frame->registers, frame->noise, &frame->stereo, machine->audio.registers.right, machine->audio.blip.right, 1, clocks);
+
+    blip_read_samples(machine->audio.blip.left, samples, count, TIC_STEREO_CHANNELS);
+    blip_read_samples(machine->audio.blip.right, samples + 1, count, TIC_STEREO_CHANNELS);
+}
+
+void tic_core_synth(tic_mem* memory, s16* samples, s32 count)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    while(count > 0)
+    {
+        if(!machine->audio.remain)
+        {
+            s32 tail = machine->audio.tail;
+
+            if(tail != tic_atomic_load(&machine->audio.head))
+            {
+                memcpy(&machine->audio.current, &machine->audio.frames[tail % TIC_SOUND_QUEUE], sizeof(tic_sound_frame));
+                tic_atomic_store(&machine->audio.tail, tail + 1);
+                machine->audio.starved = 0;
+            }
+            else
+            {
+                // a late frame plays the registers before it, they fade out if the ticks stall
+                if(machine->audio.starved++)
+                    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+                        machine->audio.current.registers[i].volume = 0;
+
+                machine->audio.current.samples = machine->samplerate / TIC80_FRAMERATE;
+                tic_atomic_store(&machine->audio.underruns, machine->audio.underruns + 1);
+            }
+
+            tic_atomic_store(&machine->audio.remain, machine->audio.current.samples);
+        }
+
+        s32 size = MIN(count, machine->audio.remain);
+        synthSound(machine, samples, size);
+
+        samples += size * TIC_STEREO_CHANNELS;
+        count -= size;
+        tic_atomic_store(&machine->audio.remain, machine->audio.remain - size);
+    }
+}
+
+s32 tic_core_audio_queued(tic_mem* memory)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    // frames are as long as the rate made them when they were queued; while the audio thread
+    // takes the next frame it can be counted twice or not at all, a frame off for that moment
+    s32 samples = tic_atomic_load(&machine->audio.remain);
+    s32 head = machine->audio.head;
+
+    for(s32 i = tic_atomic_load(&machine->audio.tail); i != head; i++)
+        samples += machine->audio.frames[i % TIC_SOUND_QUEUE].samples;
+
+    return samples;
+}
+
+s32 tic_core_audio_underruns(tic_mem* memory)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    return tic_atomic_load(&machine->audio.underruns);
+}
+
+void tic_core_audio_rate(tic_mem* memory, s32 rate)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    machine->audio.rate = CLAMP(rate, TIC_AUDIO_RATE / 2, TIC_AUDIO_RATE * 2);
+}
+
+// synthesis starts over from silence, blip keeps no deltas from before
+static void clearSynth(tic_machine* machine)
+{
+    blip_clear(machine->blip.left);
+    blip_clear(machine->blip.right);
+
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        machine->state.registers.left[i].amp = machine->state.registers.right[i].amp = 0;
+}
+
+// ticks the sound of one frame without input or video and hands its samples to output, returns their count
+static s32 renderFrame(tic_machine* machine, u8 channels, tic_sound_output output, void* data)
+{
+    tic_mem* memory = &machine->memory;
+    s32 size = machine->samplerate / TIC80_FRAMERATE;
+
+    tickSound(memory);
+
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        if(!(channels & (1 << i)))
+            memory->ram.registers[i].volume = 0;
+
+    bool noise[TIC_SOUND_CHANNELS];
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+        noise[i] = isNoiseWave(machine, i);
+
+    synthFrame(machine, noise);
+    output(data, memory->samples.buffer, size);
+
+    return size;
+}
+
+// renders start from silence and leave nothing playing behind them
+static void resetSound(tic_machine* machine)
+{
+    soundClear(&machine->memory);
+    clearSynth(machine);
+}
+
+s32 tic_core_render_sfx(tic_mem* memory, s32 index, tic_sound_output output, void* data)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    s32 rendered = 0;
+
+    if(index < 0 || index >= SFX_COUNT)
+        return 0;
+
+    resetSound(machine);
+
+    const tic_sample* effect = &getSyncSfx(machine)->samples.data[index];
+
+    enum{Channel = 0};
+    tic_api_sfx(memory, index, effect->note, effect->octave, -1, Channel, MAX_VOLUME, SFX_DEF_SPEED);
+
+    // one pass through the envelopes, loops would play forever
+    for(s32 ticks = 0, pos = 0; pos < SFX_TICKS; pos = tic_tool_sfx_pos(effect->speed, ++ticks))
+        rendered += renderFrame(machine, 1 << Channel, output, data);
+
+    resetSound(machine);
+
+    return rendered;
+}
+
+s32 tic_core_render_music(tic_mem* memory, s32 track, bool sustain, u8 channels, tic_sound_output output, void* data)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    s32 rendered = 0;
+
+    // tracks jumping back with a command never stop on their own
+    enum{MaxFrames = TIC80_FRAMERATE * 60 * 10};
+
+    if(track < 0 || track >= MUSIC_TRACKS)
+        return 0;
+
+    resetSound(machine);
+
+    tic_api_music(memory, track, -1, -1, false, sustain);
+
+    for(s32 frame = 0; memory->ram.sound_state.flag.music_state == tic_music_play && frame < MaxFrames; frame++)
+        rendered += renderFrame(machine, channels, output, data);
+
+    resetSound(machine);
+
+    return rendered;
 }
 
 void tic_api_sfx(tic_mem* memory, s32 index, s32 note, s32 octave, s32 duration, s32 channel, s32 volume, s32 speed)
@@ -1549,7 +2945,7 @@ void tic_api_sfx(tic_mem* memory, s32 index, s32 note, s32 octave, s32 duration,
 
 static void initCover(tic_mem* tic)
 {
-    const tic_cover_image* cover = &tic->cart.cover;
+    const tic_cover_image* cover = &tic->cart->cover;
 
     if(cover->size)
     {
@@ -1564,9 +2960,11 @@ static void initCover(tic_mem* tic)
                 for (s32 i = 0; i < Size; i++)
                 {
                     const gif_color* c = &image->palette[image->buffer[i]];
-                    u8 color = tic_tool_find_closest_color(tic->cart.bank0.palette.colors, c);
+                    u8 color = tic_tool_find_closest_color(getCartBank(tic, 0)->palette.colors, c);
                     tic_tool_poke4(tic->ram.vram.screen.data, i, color);
                 }
+
+                tic_core_invalidate(tic, offsetof(tic_ram, vram.screen), sizeof(tic_screen));
             }
 
             gif_close(image);
@@ -1576,20 +2974,9 @@ static void initCover(tic_mem* tic)
 
 void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
 {
-    tic_machine* machine = (tic_machine*)tic;
-
-    static const struct {s32 bank; s32 ram; s32 size;} Sections[] = 
-    {
-        {offsetof(tic_bank, tiles),     offsetof(tic_ram, tiles),           sizeof(tic_tiles)   },
-        {offsetof(tic_bank, sprites),   offsetof(tic_ram, sprites),         sizeof(tic_tiles)   },
-        {offsetof(tic_bank, map),       offsetof(tic_ram, map),             sizeof(tic_map)     },
-        {offsetof(tic_bank, sfx),       offsetof(tic_ram, sfx),             sizeof(tic_sfx)     },
-        {offsetof(tic_bank, music),     offsetof(tic_ram, music),           sizeof(tic_music)   },
-        {offsetof(tic_bank, palette),   offsetof(tic_ram, vram.palette),    sizeof(tic_palette) },
-        {offsetof(tic_bank, flags),     offsetof(tic_ram, flags),           sizeof(tic_flags)   },
-    };
+    tic_machine* machine = (tic_machine*)tic;
 
-    enum{Count = COUNT_OF(Sections), Mask = (1 << Count) - 1};
+    enum{Count = TIC_SYNC_SECTIONS, Mask = (1 << Count) - 1};
 
     if(mask == 0) mask = Mask;
     
@@ -1600,11 +2987,36 @@ void tic_api_sync(tic_mem* tic, u32 mask, s32 bank, bool toCart)
     for(s32 i = 0; i < Count; i++)
     {
         if(mask & (1 << i))
-            toCart
-                ? memcpy((u8*)&tic->cart.banks[bank] + Sections[i].bank, (u8*)&tic->ram + Sections[i].ram, Sections[i].size)
-                : memcpy((u8*)&tic->ram + Sections[i].ram, (u8*)&tic->cart.banks[bank] + Sections[i].bank, Sections[i].size);
+        {
+            if(toCart)
+            {
+                tic_bank* dst = getCartBankWrite(tic, bank);
+                loadSyncSections(machine, SyncSections[i].ram, SyncSections[i].size, false);
+                machine->cart.written |= 1 << bank;
+
+                if(dst)
+                    memcpy((u8*)dst + SyncSections[i].bank, (u8*)&tic->ram + SyncSections[i].ram, SyncSections[i].size);
+            }
+            else
+            {
+                flushDeferredWrite(machine, SyncSections[i].ram, SyncSections[i].size);
+
+                // the palette is read by every blit, it's always copied
+                if(machine->mapping.enabled && i != SyncPalette)
+                    machine->mapping.banks[i] = bank + 1;
+                else
+                    memcpy((u8*)&tic->ram + SyncSections[i].ram, (u8*)getCartBank(tic, bank) + SyncSections[i].bank, SyncSections[i].size);
+
+                invalidateRam(machine, SyncSections[i].ram, SyncSections[i].size);
+            }
+        }
     }
 
+    // the tile cache reads the whole sheet from one place
+    if(machine->mapping.banks[SyncTiles] != machine->mapping.banks[SyncSprites])
+        loadSyncSections(machine, offsetof(tic_ram, tiles), sizeof(tic_tiles) * TIC_SPRITE_BANKS, false);
+
+    machine->tilecache.tiles = getSyncSection(machine, SyncTiles);
     machine->state.synced |= mask;
 }
 
@@ -1616,6 +3028,7 @@ static void cart2ram(tic_mem* memory)
     };
 
     memcpy(memory->ram.font.data, Font, sizeof Font);
+    tic_core_invalidate(memory, offsetof(tic_ram, font), sizeof Font);
 
     tic_api_sync(memory, 0, 0, false);
     initCover(memory);
@@ -1682,7 +3095,7 @@ static bool compareMetatag(const char* code, const char* tag, const char* value,
 
 const tic_script_config* tic_core_script_config(tic_mem* memory)
 {
-    const char* code = memory->cart.code.data;
+    const char* code = memory->cart->code.data;
 
 #if defined(TIC_BUILD_WITH_MOON)
     if(compareMetatag(code, "script", "moon", getMoonScriptConfig()->singleComment) ||
@@ -1725,7 +3138,7 @@ const tic_script_config* tic_core_script_config(tic_mem* memory)
 static void updateSaveid(tic_mem* memory)
 {
     memset(memory->saveid, 0, sizeof memory->saveid);
-    const char* saveid = readMetatag(memory->cart.code.data, "saveid", tic_core_script_config(memory)->singleComment);
+    const char* saveid = readMetatag(memory->cart->code.data, "saveid", tic_core_script_config(memory)->singleComment);
     if(saveid)
     {
         strncpy(memory->saveid, saveid, TIC_SAVEID_SIZE-1);
@@ -1733,73 +3146,359 @@ static void updateSaveid(tic_mem* memory)
     }
 }
 
+static bool initScript(tic_mem* tic)
+{
+    tic_machine* machine = (tic_machine*)tic;
+    tic_tick_data* data = machine->data;
+    const char* code = tic->cart->code.data;
+
+    bool done = false;
+    const tic_script_config* config = NULL;
+
+    if(strlen(code))
+    {
+        config = tic_core_script_config(tic);
+        cart2ram(tic);
+
+        machine->state.synced = 0;
+        tic->input.data = 0;
+        
+        if(compareMetatag(code, "input", "mouse", config->singleComment))
+            tic->input.mouse = 1;
+        else if(compareMetatag(code, "input", "gamepad", config->singleComment))
+            tic->input.gamepad = 1;
+        else if(compareMetatag(code, "input", "keyboard", config->singleComment))
+            tic->input.keyboard = 1;
+        else tic->input.data = -1;  // default is all enabled
+
+        data->start = data->counter(data->data);
+        
+        done = config->init(tic, code);
+    }
+    else
+    {
+        data->error(data->data, "the code is empty");
+    }
+
+    if(done)
+    {
+        machine->state.tick = config->tick;
+        machine->state.scanline = config->scanline;
+        machine->state.ovr.callback = config->overline;
+
+        machine->state.initialized = true;
+    }
+
+    return done;
+}
+
 void tic_core_tick(tic_mem* tic, tic_tick_data* data)
 {
     tic_machine* machine = (tic_machine*)tic;
 
     machine->data = data;
     
-    if(!machine->state.initialized)
+    if(!machine->state.initialized && !initScript(tic))
+        return;
+
     {
-        const char* code = tic->cart.code.data;
+        if(!tic->input.keyboard)
+            ZEROMEM(tic->ram.input.keyboard);
 
-        bool done = false;
-        const tic_script_config* config = NULL;
+        if(!tic->input.gamepad)
+            ZEROMEM(tic->ram.input.gamepads);
 
-        if(strlen(code))
-        {
-            config = tic_core_script_config(tic);
-            cart2ram(tic);
+        if(!tic->input.mouse)
+            ZEROMEM(tic->ram.input.mouse);
+    }
 
-            machine->state.synced = 0;
-            tic->input.data = 0;
-            
-            if(compareMetatag(code, "input", "mouse", config->singleComment))
-                tic->input.mouse = 1;
-            else if(compareMetatag(code, "input", "gamepad", config->singleComment))
-                tic->input.gamepad = 1;
-            else if(compareMetatag(code, "input", "keyboard", config->singleComment))
-                tic->input.keyboard = 1;
-            else tic->input.data = -1;  // default is all enabled
-
-            data->start = data->counter();
-            
-            done = config->init(tic, code);
+    machine->state.tick(tic);
+}
+
+// save state layout: header, ram, machine state with the pointers cleared, script state
+typedef struct
+{
+    u32 magic;
+    u32 version;
+    u32 ram;
+    u32 state;
+    u64 elapsed;
+    // music rows waiting on a delay command, -1 if there are none
+    s32 delay[TIC_SOUND_CHANNELS];
+    s32 script;
+    // sections left mapped to an unchanged cart bank, the ram holds zeros for them
+    u8 banks[TIC_SYNC_SECTIONS];
+} StateHeader;
+
+enum {StateMagic = 0x53434954, StateVersion = 2, StateFixed = sizeof(StateHeader) + sizeof(tic_ram) + sizeof(tic_machine_state_data)};
+
+static s32 getDelayRow(tic_machine* machine, const tic_track_row* row)
+{
+    enum {Rows = MUSIC_PATTERNS * MUSIC_PATTERN_ROWS};
+
+    if(!row) return -1;
+
+    const tic_track_row* rows = machine->memory.ram.music.patterns.data->rows;
+    if(row >= rows && row < rows + Rows)
+        return (s32)(row - rows);
+
+    for(s32 i = 0; i < TIC_BANKS; i++)
+    {
+        rows = getCartBank(&machine->memory, i)->music.patterns.data->rows;
+        if(row >= rows && row < rows + Rows)
+            return (s32)(row - rows);
+    }
+
+    return -1;
+}
+
+// ram as the script sees it, without reading mapped sections into it
+static void saveStateRam(tic_machine* machine, u8* dst, u8* banks)
+{
+    memcpy(dst, &machine->memory.ram, sizeof(tic_ram));
+
+    for(s32 i = 0; i < TIC_SYNC_SECTIONS; i++)
+    {
+        u8 bank = machine->mapping.banks[i];
+
+        banks[i] = bank && !(machine->cart.written & (1 << (bank - 1))) ? bank : 0;
+
+        if(banks[i])
+            memset(dst + SyncSections[i].ram, 0, SyncSections[i].size);
+        else if(bank)
+            memcpy(dst + SyncSections[i].ram, getSyncSection(machine, i), SyncSections[i].size);
+    }
+}
+
+// takes the saved ram and mapping over, only the blocks that changed are invalidated
+static void loadStateRam(tic_machine* machine, const u8* src, const u8* banks)
+{
+    enum {Block = 1024};
+
+    u8* ram = (u8*)&machine->memory.ram;
+    bool unmapped[TIC_SYNC_SECTIONS];
+
+    for(s32 i = 0; i < TIC_SYNC_SECTIONS; i++)
+    {
+        u8 bank = machine->mapping.enabled ? banks[i] : 0;
+
+        // ram of a section that was mapped is stale, it's taken whatever it holds
+        unmapped[i] = machine->mapping.banks[i] && !bank;
+
+        if(bank)
+        {
+            if(bank != machine->mapping.banks[i])
+            {
+                machine->mapping.banks[i] = bank;
+                invalidateRam(machine, SyncSections[i].ram, SyncSections[i].size);
+            }
         }
         else
         {
-            machine->data->error(machine->data->data, "the code is empty");
+            machine->mapping.banks[i] = 0;
+
+            // this instance doesn't map banks, the section is copied from the cart
+            if(banks[i])
+            {
+                memcpy(ram + SyncSections[i].ram, (const u8*)getCartBank(&machine->memory, banks[i] - 1) + SyncSections[i].bank, SyncSections[i].size);
+                invalidateRam(machine, SyncSections[i].ram, SyncSections[i].size);
+            }
         }
+    }
+
+    for(s32 address = 0; address < sizeof(tic_ram);)
+    {
+        s32 end = MIN(address + Block, (s32)sizeof(tic_ram));
+        bool skip = false, force = false;
 
-        if(done)
+        // a block never crosses a section edge
+        for(s32 i = 0; i < TIC_SYNC_SECTIONS; i++)
         {
-            machine->state.tick = config->tick;
-            machine->state.scanline = config->scanline;
-            machine->state.ovr.callback = config->overline;
+            s32 start = SyncSections[i].ram;
+            s32 stop = start + SyncSections[i].size;
+
+            if(address >= start && address < stop)
+            {
+                skip = banks[i] != 0;
+                force = unmapped[i];
+                end = skip ? stop : MIN(end, stop);
+            }
+            else if(start > address && start < end)
+                end = start;
+        }
 
-            machine->state.initialized = true;
+        if(!skip && (force || memcmp(ram + address, src + address, end - address)))
+        {
+            memcpy(ram + address, src + address, end - address);
+            invalidateRam(machine, address, end - address);
         }
-        else return;
+
+        address = end;
     }
 
+    machine->tilecache.tiles = getSyncSection(machine, SyncTiles);
+}
+
+static void clearStatePointers(tic_machine_state_data* state)
+{
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
     {
-        if(!tic->input.keyboard)
-            ZEROMEM(tic->ram.input.keyboard);
+        state->sfx.channels[i].pos = NULL;
+        state->music.channels[i].pos = NULL;
+        state->music.commands[i].delay.row = NULL;
+    }
 
-        if(!tic->input.gamepad)
-            ZEROMEM(tic->ram.input.gamepads);
+    state->tick = NULL;
+    state->scanline = NULL;
+    state->ovr.callback = NULL;
+    state->setpix = NULL;
+    state->getpix = NULL;
+    state->drawhline = NULL;
+    state->drawspan = NULL;
+}
 
-        if(!tic->input.mouse)
-            ZEROMEM(tic->ram.input.mouse);
+s32 tic_core_save_state(tic_mem* memory, void* buffer, s32 size)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    const tic_script_config* config = tic_core_script_config(memory);
+
+    s32 script = 0;
+
+    if(machine->state.initialized)
+    {
+        if(!config->save)
+        {
+            machine->data->error(machine->data->data, "this script language can't save its state yet");
+            return 0;
+        }
+
+        script = config->save(memory, buffer && size > StateFixed ? (u8*)buffer + StateFixed : NULL, MAX(size - StateFixed, 0));
+
+        if(!script)
+            return 0;
     }
 
-    machine->state.tick(tic);
+    s32 total = StateFixed + script;
+
+    if(buffer && size >= total)
+    {
+        flushScreen(machine, 0, sizeof(tic_ram));
+
+        StateHeader header = 
+        {
+            .magic = StateMagic,
+            .version = StateVersion,
+            .ram = sizeof(tic_ram),
+            .state = sizeof(tic_machine_state_data),
+            .elapsed = machine->data ? machine->data->counter(machine->data->data) - machine->data->start : 0,
+            .script = script,
+        };
+
+        for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+            header.delay[i] = getDelayRow(machine, machine->state.music.commands[i].delay.row);
+
+        u8* ptr = buffer;
+        saveStateRam(machine, ptr + sizeof header, header.banks);
+        memcpy(ptr, &header, sizeof header);
+        ptr += sizeof header;
+
+        tic_machine_state_data* state = (tic_machine_state_data*)(ptr += sizeof(tic_ram));
+        memcpy(state, &machine->state, sizeof(tic_machine_state_data));
+        clearStatePointers(state);
+    }
+
+    return total;
+}
+
+static bool loadState(tic_mem* memory, tic_tick_data* data, const void* buffer, s32 size, bool script)
+{
+    tic_machine* machine = (tic_machine*)memory;
+    const tic_script_config* config = tic_core_script_config(memory);
+
+    StateHeader header;
+
+    if(size < StateFixed)
+        return false;
+
+    memcpy(&header, buffer, sizeof header);
+
+    if(header.magic != StateMagic || header.version != StateVersion 
+        || header.ram != sizeof(tic_ram) || header.state != sizeof(tic_machine_state_data)
+        || header.script < 0 || header.script > size - StateFixed)
+        return false;
+
+    const u8* ptr = (const u8*)buffer + sizeof header;
+    tic_machine_state_data state;
+    memcpy(&state, ptr + sizeof(tic_ram), sizeof state);
+
+    machine->data = data;
+
+    // without the script part the running script goes on with its own state
+    if(!script)
+        state.initialized = machine->state.initialized;
+    else if(state.initialized)
+    {
+        if(!config->load)
+        {
+            data->error(data->data, "this script language can't load its state yet");
+            return false;
+        }
+
+        // the script has to run to get back the functions its state refers to
+        if(!machine->state.initialized && !initScript(memory))
+            return false;
+
+        if(!config->load(memory, ptr + sizeof(tic_ram) + sizeof state, header.script))
+        {
+            data->error(data->data, "the script state doesn't match the running code");
+            return false;
+        }
+    }
+
+    // the screen is compared with the saved one, shadow pixels are repacked first
+    flushScreen(machine, 0, sizeof(tic_ram));
+    loadStateRam(machine, ptr, header.banks);
+
+    for(s32 i = 0; i < TIC_SOUND_CHANNELS; i++)
+    {
+        state.sfx.channels[i].pos = &memory->ram.sfxpos[i];
+        state.music.channels[i].pos = &machine->state.music.sfxpos[i];
+        state.music.commands[i].delay.row = header.delay[i] >= 0 
+            ? getSyncMusic(machine)->patterns.data->rows + header.delay[i] : NULL;
+    }
+
+    state.tick = machine->state.tick;
+    state.scanline = machine->state.scanline;
+    state.ovr.callback = machine->state.ovr.callback;
+    state.setpix = machine->state.setpix;
+    state.getpix = machine->state.getpix;
+    state.drawhline = machine->state.drawhline;
+    state.drawspan = machine->state.drawspan;
+
+    memcpy(&machine->state, &state, sizeof state);
+
+    // synthesis starts over from the saved registers
+    clearSynth(machine);
+
+    data->start = data->counter(data->data) - header.elapsed;
+
+    return true;
+}
+
+bool tic_core_load_state(tic_mem* memory, tic_tick_data* data, const void* buffer, s32 size)
+{
+    return loadState(memory, data, buffer, size, true);
+}
+
+bool tic_core_load_state_ram(tic_mem* memory, tic_tick_data* data, const void* buffer, s32 size)
+{
+    return loadState(memory, data, buffer, size, false);
 }
 
 double tic_api_time(tic_mem* memory)
 {
     tic_machine* machine = (tic_machine*)memory;
-    return (double)((machine->data->counter() - machine->data->start)*1000)/machine->data->freq();
+    return (double)((machine->data->counter(machine->data->data) - machine->data->start)*1000)/machine->data->freq(machine->data->data);
 }
 
 s32 tic_api_tstamp(tic_mem* memory)
@@ -1922,19 +3621,93 @@ static inline void memset4(void *dst, u32 val, u32 dwords)
 #endif
 }
 
-void tic_core_blit_ex(tic_mem* tic, tic80_pixel_color_format fmt, tic_scanline scanline, tic_overline overline, void* data)
+// converts vram palette to the output format only when it has changed
+static const u32* getBlitPalette(tic_machine* machine, tic80_pixel_color_format fmt)
+{
+    const tic_palette* src = &machine->memory.ram.vram.palette;
+
+    if(!machine->palette.valid 
+        || machine->palette.format != fmt 
+        || memcmp(&machine->palette.src, src, sizeof(tic_palette)) != 0)
+    {
+        memcpy(&machine->palette.src, src, sizeof(tic_palette));
+        machine->palette.format = fmt;
+        tic_tool_palette_blit(machine->palette.colors, src, fmt);
+
+        machine->palette.version++;
+        machine->palette.valid = true;
+        machine->palette.paired = false;
+    }
+
+    return machine->palette.colors;
+}
+
+// expands a byte of two 4bpp pixels into two colors at once
+static const u32 (*getBlitPalettePairs(tic_machine* machine))[2]
+{
+    if(!machine->palette.paired)
+    {
+        const u32* pal = machine->palette.colors;
+
+        for(s32 i = 0; i < COUNT_OF(machine->palette.pairs); i++)
+        {
+            machine->palette.pairs[i][0] = pal[i & 0xf];
+            machine->palette.pairs[i][1] = pal[i >> TIC_PALETTE_BPP];
+        }
+
+        machine->palette.paired = true;
+    }
+
+    return machine->palette.pairs;
+}
+
+// tells if the output row has to be converted again with the current palette and vars
+static bool updateBlitState(tic_machine* machine, tic_blit_state* state, s8 x, s8 y)
 {
-    const u32* pal = tic_tool_palette_blit(&tic->ram.vram.palette, fmt);
+    const tic_vram* vram = &machine->memory.ram.vram;
+
+    if(state->palette == machine->palette.version
+        && state->border == vram->vars.border
+        && state->x == x && state->y == y)
+        return false;
+
+    state->palette = machine->palette.version;
+    state->border = vram->vars.border;
+    state->x = x;
+    state->y = y;
+
+    return true;
+}
 
+static void setBlitDirty(tic_mem* tic, s32 top, s32 bottom)
+{
+    if(tic->screen_dirty.top == tic->screen_dirty.bottom)
+    {
+        tic->screen_dirty.top = top;
+        tic->screen_dirty.bottom = bottom;
+    }
+    else
     {
-        tic_machine* machine = (tic_machine*)tic;
-        memcpy(machine->state.ovr.palette, pal, sizeof machine->state.ovr.palette);
+        tic->screen_dirty.top = MIN(tic->screen_dirty.top, top);
+        tic->screen_dirty.bottom = MAX(tic->screen_dirty.bottom, bottom);
     }
+}
+
+void tic_core_blit_ex(tic_mem* tic, tic80_pixel_color_format fmt, tic_scanline scanline, tic_overline overline, void* data)
+{
+    tic_machine* machine = (tic_machine*)tic;
+
+    flushScreen(machine, 0, sizeof(tic_ram));
+
+    const u32* pal = getBlitPalette(machine, fmt);
+
+    memcpy(machine->state.ovr.palette, pal, sizeof machine->state.ovr.palette);
+    initOvrLookup(machine);
 
     if(scanline)
     {
         scanline(tic, 0, data);
-        pal = tic_tool_palette_blit(&tic->ram.vram.palette, fmt);
+        pal = getBlitPalette(machine, fmt);
     }
 
     enum {Top = (TIC80_FULLHEIGHT-TIC80_HEIGHT)/2, Bottom = Top};
@@ -1942,38 +3715,73 @@ void tic_core_blit_ex(tic_mem* tic, tic80_pixel_color_format fmt, tic_scanline s
 
     u32* out = tic->screen;
 
-    memset4(&out[0 * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Top);
+    tic->screen_dirty.top = tic->screen_dirty.bottom = 0;
+
+    if(updateBlitState(machine, &machine->blit.top, 0, 0))
+    {
+        memset4(&out[0 * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Top);
+        setBlitDirty(tic, 0, Top);
+    }
 
     u32* rowPtr = out + (Top*TIC80_FULLWIDTH);
     for(s32 r = 0; r < TIC80_HEIGHT; r++, rowPtr += TIC80_FULLWIDTH)
     {
-        u32 *colPtr = rowPtr + Left;
-        memset4(rowPtr, pal[tic->ram.vram.vars.border], Left);
+        s32 row = (r + tic->ram.vram.vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT;
 
-        s32 pos = (r + tic->ram.vram.vars.offset.y + TIC80_HEIGHT) % TIC80_HEIGHT * TIC80_WIDTH >> 1;
-
-        u32 x = (-tic->ram.vram.vars.offset.x + TIC80_WIDTH) % TIC80_WIDTH;
-        for(s32 c = 0; c < TIC80_WIDTH / 2; c++)
+        // rows nobody has drawn to since the last blit still hold the same colors
+        if(updateBlitState(machine, &machine->blit.state[r], tic->ram.vram.vars.offset.x, tic->ram.vram.vars.offset.y)
+            || machine->blit.rows[row] || machine->blit.ovr[r])
         {
-            u8 val = ((u8*)tic->ram.vram.screen.data)[pos + c];
-            *(colPtr + (x++ % TIC80_WIDTH)) = pal[val & 0xf];
-            *(colPtr + (x++ % TIC80_WIDTH)) = pal[val >> 4];
+            machine->blit.rows[row] = false;
+            machine->blit.ovr[r] = false;
+            setBlitDirty(tic, Top + r, Top + r + 1);
+
+            u32 *colPtr = rowPtr + Left;
+            memset4(rowPtr, pal[tic->ram.vram.vars.border], Left);
+
+            s32 pos = row * TIC80_WIDTH >> 1;
+
+            if(tic->ram.vram.vars.offset.x == 0)
+            {
+                const u32 (*pairs)[2] = getBlitPalettePairs(machine);
+
+                const u8* src = tic->ram.vram.screen.data + pos;
+                for(s32 c = 0; c < TIC80_WIDTH / 2; c++, colPtr += 2)
+                    memcpy(colPtr, pairs[src[c]], sizeof *pairs);
+            }
+            else
+            {
+                u32 x = (-tic->ram.vram.vars.offset.x + TIC80_WIDTH) % TIC80_WIDTH;
+                for(s32 c = 0; c < TIC80_WIDTH / 2; c++)
+                {
+                    u8 val = ((u8*)tic->ram.vram.screen.data)[pos + c];
+                    *(colPtr + (x++ % TIC80_WIDTH)) = pal[val & 0xf];
+                    *(colPtr + (x++ % TIC80_WIDTH)) = pal[val >> 4];
+                }
+            }
+
+            memset4(rowPtr + (TIC80_FULLWIDTH-Right), pal[tic->ram.vram.vars.border], Right);
         }
 
-        memset4(rowPtr + (TIC80_FULLWIDTH-Right), pal[tic->ram.vram.vars.border], Right);
-            
         if(scanline && (r < TIC80_HEIGHT-1))
         {
             scanline(tic, r+1, data);
-            pal = tic_tool_palette_blit(&tic->ram.vram.palette, fmt);
+            pal = getBlitPalette(machine, fmt);
         }
     }
 
-    memset4(&out[(TIC80_FULLHEIGHT-Bottom) * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Bottom);
+    if(updateBlitState(machine, &machine->blit.bottom, 0, 0))
+    {
+        memset4(&out[(TIC80_FULLHEIGHT-Bottom) * TIC80_FULLWIDTH], pal[tic->ram.vram.vars.border], TIC80_FULLWIDTH*Bottom);
+        setBlitDirty(tic, TIC80_FULLHEIGHT-Bottom, TIC80_FULLHEIGHT);
+    }
 
     if(overline)
         overline(tic, data);
 
+    for(s32 r = 0; r < TIC80_HEIGHT; r++)
+        if(machine->blit.ovr[r])
+            setBlitDirty(tic, Top + r, Top + r + 1);
 }
 
 static inline void scanline(tic_mem* memory, s32 row, void* data)
@@ -1997,10 +3805,29 @@ void tic_core_blit(tic_mem* tic, tic80_pixel_color_format fmt)
     tic_core_blit_ex(tic, fmt, scanline, overline, NULL);
 }
 
+void tic_core_blit_skip(tic_mem* tic, tic80_pixel_color_format fmt)
+{
+    tic_machine* machine = (tic_machine*)tic;
+
+    memcpy(machine->state.ovr.palette, getBlitPalette(machine, fmt), sizeof machine->state.ovr.palette);
+    initOvrLookup(machine);
+
+    for(s32 r = 0; r < TIC80_HEIGHT; r++)
+        scanline(tic, r, NULL);
+
+    overline(tic, NULL);
+
+    tic->screen_dirty.top = tic->screen_dirty.bottom = 0;
+}
+
 u8 tic_api_peek(tic_mem* memory, s32 address)
 {
     if(address >=0 && address < sizeof(tic_ram))
+    {
+        flushScreen((tic_machine*)memory, address, 1);
+        loadSyncSections((tic_machine*)memory, address, 1, false);
         return *((u8*)&memory->ram + address);
+    }
 
     return 0;
 }
@@ -2008,13 +3835,21 @@ u8 tic_api_peek(tic_mem* memory, s32 address)
 void tic_api_poke(tic_mem* memory, s32 address, u8 value)
 {
     if(address >=0 && address < sizeof(tic_ram))
+    {
+        flushDeferredWrite((tic_machine*)memory, address, 1);
         *((u8*)&memory->ram + address) = value;
+        tic_core_invalidate(memory, address, 1);
+    }
 }
 
 u8 tic_api_peek4(tic_mem* memory, s32 address)
 {
     if(address >=0 && address < sizeof(tic_ram)*2)
+    {
+        flushScreen((tic_machine*)memory, address >> 1, 1);
+        loadSyncSections((tic_machine*)memory, address >> 1, 1, false);
         return tic_tool_peek4((u8*)&memory->ram, address);
+    }
 
     return 0;
 }
@@ -2022,7 +3857,13 @@ u8 tic_api_peek4(tic_mem* memory, s32 address)
 void tic_api_poke4(tic_mem* memory, s32 address, u8 value)
 {
     if(address >=0 && address < sizeof(tic_ram)*2)
+    {
+        flushScreen((tic_machine*)memory, address >> 1, 1);
+        loadSyncSections((tic_machine*)memory, address >> 1, 1, false);
+        flushDeferredWrite((tic_machine*)memory, address >> 1, 1);
         tic_tool_poke4((u8*)&memory->ram, address, value);
+        tic_core_invalidate(memory, address >> 1, 1);
+    }
 }
 
 void tic_api_memcpy(tic_mem* memory, s32 dst, s32 src, s32 size)
@@ -2037,7 +3878,11 @@ void tic_api_memcpy(tic_mem* memory, s32 dst, s32 src, s32 size)
         && src <= bound)
     {
         u8* base = (u8*)&memory->ram;
+        flushScreen((tic_machine*)memory, src, size);
+        loadSyncSections((tic_machine*)memory, src, size, false);
+        flushDeferredWrite((tic_machine*)memory, dst, size);
         memcpy(base + dst, base + src, size);
+        tic_core_invalidate(memory, dst, size);
     }
 }
 
@@ -2051,10 +3896,59 @@ void tic_api_memset(tic_mem* memory, s32 dst, u8 val, s32 size)
         && dst <= bound)
     {
         u8* base = (u8*)&memory->ram;
+        flushDeferredWrite((tic_machine*)memory, dst, size);
         memset(base + dst, val, size);
+        tic_core_invalidate(memory, dst, size);
     }
 }
 
+void tic_core_invalidate(tic_mem* memory, s32 address, s32 size)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    // ram holds the written bytes now, the rest of their sections comes from the banks
+    loadSyncSections(machine, address, size, true);
+    invalidateRam(machine, address, size);
+}
+
+void tic_core_materialize(tic_mem* memory, s32 address, s32 size)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    flushScreen(machine, address, size);
+    loadSyncSections(machine, address, size, false);
+}
+
+void tic_core_map_banks(tic_mem* memory, bool enabled)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    if(!enabled)
+        loadSyncSections(machine, 0, sizeof(tic_ram), false);
+
+    machine->mapping.enabled = enabled;
+}
+
+void tic_core_shadow(tic_mem* memory, bool enabled)
+{
+    tic_machine* machine = (tic_machine*)memory;
+
+    if(machine->shadow.enabled == enabled) return;
+
+    flushDeferred(machine);
+
+    if(enabled)
+        unpackShadow(machine, 0, sizeof(tic_ram));
+    else
+        flushScreen(machine, 0, sizeof(tic_ram));
+
+    machine->shadow.enabled = enabled;
+    machine->shadow.dirty = false;
+
+    if(machine->state.setpix != setPixelOvr)
+        setDrawFuncs(machine);
+}
+
 void tic_api_trace(tic_mem* memory, const char* text, u8 color)
 {
     tic_machine* machine = (tic_machine*)memory;
@@ -2090,8 +3984,10 @@ tic_mem* tic_core_create(s32 samplerate)
         return NULL;
     }
 
+    machine->memory.cart = calloc(1, sizeof(tic_cartridge));
     machine->memory.screen_format = TIC80_PIXEL_COLOR_RGBA8888;
     machine->samplerate = samplerate;
+    initTileCache(&machine->tilecache, &machine->memory.ram);
 #ifdef _3DS
     // To feed texture data directly to the 3DS GPU, linearly allocated memory is required, which is
     // not guaranteed by malloc.
@@ -2107,6 +4003,13 @@ tic_mem* tic_core_create(s32 samplerate)
     blip_set_rates(machine->blip.left, CLOCKRATE, samplerate);
     blip_set_rates(machine->blip.right, CLOCKRATE, samplerate);
 
+    machine->audio.blip.left = blip_new(samplerate / 10);
+    machine->audio.blip.right = blip_new(samplerate / 10);
+
+    blip_set_rates(machine->audio.blip.left, CLOCKRATE, samplerate);
+    blip_set_rates(machine->audio.blip.right, CLOCKRATE, samplerate);
+    machine->audio.rate = TIC_AUDIO_RATE;
+
     tic_api_reset(&machine->memory);
 
     return &machine->memory;
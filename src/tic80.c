@@ -27,6 +27,7 @@
 #include "ticapi.h"
 #include "tools.h"
 #include "cart.h"
+#include "jobs.h"
 
 #include "ext/gif.h"
 
@@ -38,6 +39,11 @@ static void onTrace(void* data, const char* text, u8 color)
         tic->callback.trace(text, color);
 }
 
+// frames ticked ahead are played again later, they report nothing to the host
+static void onTraceAhead(void* data, const char* text, u8 color) {}
+static void onErrorAhead(void* data, const char* info) {}
+static void onExitAhead(void* data) {}
+
 static void onError(void* data, const char* info)
 {
     tic80* tic = (tic80*)data;
@@ -54,16 +60,16 @@ static void onExit(void* data)
         tic->callback.exit();
 }
 
-static u64 getFreq()
+static u64 getFreq(void* data)
 {
     return TIC80_FRAMERATE;
 }
 
-static u64 TickCounter = 0;
-
-static u64 getCounter()
+static u64 getCounter(void* data)
 {
-    return TickCounter;
+    tic80_local* tic80 = (tic80_local*)data;
+
+    return tic80->tickCounter;
 }
 
 tic80* tic80_create(s32 samplerate)
@@ -75,6 +81,8 @@ tic80* tic80_create(s32 samplerate)
         memset(tic80, 0, sizeof(tic80_local));
 
         tic80->memory = tic_core_create(samplerate);
+        tic_core_shadow(tic80->memory, true);
+        tic_core_map_banks(tic80->memory, true);
         tic80->tic.screen_format = tic80->memory->screen_format;
 
         return &tic80->tic;
@@ -83,10 +91,8 @@ tic80* tic80_create(s32 samplerate)
     return NULL;
 }
 
-TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
+static void initTickData(tic80_local* tic80)
 {
-    tic80_local* tic80 = (tic80_local*)tic;
-
     tic80->tic.sound.count = tic80->memory->samples.size/sizeof(s16);
     tic80->tic.sound.samples = tic80->memory->samples.buffer;
 
@@ -101,19 +107,53 @@ TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
         tic80->tickData.start = 0;
         tic80->tickData.freq = getFreq;
         tic80->tickData.counter = getCounter;
-        TickCounter = 0;
+        tic80->tickCounter = 0;
     }
+}
 
-    {
-        tic_cart_load(&tic80->memory->cart, cart, size);
-        tic_api_reset(tic80->memory);
-    }
+TIC80_API void tic80_load(tic80* tic, void* cart, s32 size)
+{
+    tic80_local* tic80 = (tic80_local*)tic;
+
+    initTickData(tic80);
+
+    tic_core_share_cart(tic80->memory, NULL);
+    tic_cart_load(tic80->memory->cart, cart, size);
+    tic_api_reset(tic80->memory);
 }
 
-TIC80_API void tic80_tick(tic80* tic, const tic80_input* input)
+struct tic80_cart
+{
+    tic_cartridge data;
+};
+
+TIC80_API tic80_cart* tic80_cart_create(void* cart, s32 size)
+{
+    tic80_cart* shared = malloc(sizeof(tic80_cart));
+
+    if(shared)
+        tic_cart_load(&shared->data, cart, size);
+
+    return shared;
+}
+
+TIC80_API void tic80_load_cart(tic80* tic, const tic80_cart* cart)
 {
     tic80_local* tic80 = (tic80_local*)tic;
 
+    initTickData(tic80);
+
+    tic_core_share_cart(tic80->memory, &cart->data);
+    tic_api_reset(tic80->memory);
+}
+
+TIC80_API void tic80_cart_delete(tic80_cart* cart)
+{
+    free(cart);
+}
+
+static void tick(tic80_local* tic80, const tic80_input* input, bool blit)
+{
     tic80->memory->screen_format = tic80->tic.screen_format;
     tic80->memory->ram.input = *input;
     
@@ -121,9 +161,174 @@ TIC80_API void tic80_tick(tic80* tic, const tic80_input* input)
     tic_core_tick(tic80->memory, &tic80->tickData);
     tic_core_tick_end(tic80->memory);
 
-    tic_core_blit(tic80->memory, tic80->memory->screen_format);
+    if(blit)
+        tic_core_blit(tic80->memory, tic80->memory->screen_format);
+    else
+        tic_core_blit_skip(tic80->memory, tic80->memory->screen_format);
+
+    tic80->tic.screen_dirty.top = tic80->memory->screen_dirty.top;
+    tic80->tic.screen_dirty.bottom = tic80->memory->screen_dirty.bottom;
+
+    tic80->tickCounter++;
+}
+
+TIC80_API void tic80_tick(tic80* tic, const tic80_input* input)
+{
+    tick((tic80_local*)tic, input, true);
+}
+
+TIC80_API void tic80_draw_threads(tic80* tic, s32 threads)
+{
+    tic80_local* tic80 = (tic80_local*)tic;
+
+    tic_core_deferred(tic80->memory, threads);
+}
+
+struct tic80_batch
+{
+    tic_jobs* jobs;
+
+    tic80** tics;
+    const tic80_input* inputs;
+    const bool* output;
+    s32 frames;
+};
+
+TIC80_API tic80_batch* tic80_batch_create(s32 threads)
+{
+    tic80_batch* batch = calloc(1, sizeof(tic80_batch));
 
-    TickCounter++;
+    if(batch && !(batch->jobs = tic_jobs_create(threads)))
+    {
+        free(batch);
+        return NULL;
+    }
+
+    return batch;
+}
+
+static void batchTick(void* data, s32 index)
+{
+    const tic80_batch* batch = data;
+    tic80_local* tic80 = (tic80_local*)batch->tics[index];
+    bool output = !batch->output || batch->output[index];
+
+    tic_core_sound(tic80->memory, output);
+
+    // only the last frame is blitted, the rows changed before it are still marked dirty
+    for(s32 i = 0; i < batch->frames; i++)
+        tick(tic80, batch->inputs + index, output && i == batch->frames - 1);
+
+    tic_core_sound(tic80->memory, true);
+}
+
+TIC80_API void tic80_batch_tick(tic80_batch* batch, tic80** tics, const tic80_input* inputs, const bool* output, s32 count, s32 frames)
+{
+    batch->tics = tics;
+    batch->inputs = inputs;
+    batch->output = output;
+    batch->frames = frames;
+
+    tic_jobs_run(batch->jobs, batchTick, batch, count);
+}
+
+TIC80_API void tic80_batch_delete(tic80_batch* batch)
+{
+    if(!batch) return;
+
+    tic_jobs_close(batch->jobs);
+    free(batch);
+}
+
+TIC80_API s32 tic80_save_state(tic80* tic, void* buffer, s32 size)
+{
+    tic80_local* tic80 = (tic80_local*)tic;
+
+    return tic_core_save_state(tic80->memory, buffer, size);
+}
+
+TIC80_API bool tic80_load_state(tic80* tic, const void* buffer, s32 size)
+{
+    tic80_local* tic80 = (tic80_local*)tic;
+
+    if(!tic_core_load_state(tic80->memory, &tic80->tickData, buffer, size))
+        return false;
+
+    // the screen is redrawn from the loaded vram, the script callbacks ran when it was saved
+    tic_core_blit_ex(tic80->memory, tic80->memory->screen_format, NULL, NULL, NULL);
+
+    tic80->tic.screen_dirty.top = 0;
+    tic80->tic.screen_dirty.bottom = TIC80_FULLHEIGHT;
+
+    return true;
+}
+
+TIC80_API bool tic80_tick_ahead(tic80* tic, const tic80_input* input, s32 frames)
+{
+    tic80_local* tic80 = (tic80_local*)tic;
+    tic_mem* memory = tic80->memory;
+
+    // scripts that can't save their state never print an error for it here
+    if(frames <= 0 || tic80->ahead.off || !tic_core_script_config(memory)->save)
+        return false;
+
+    s32 size = tic_core_save_state(memory, tic80->ahead.state, tic80->ahead.size);
+
+    if(size > tic80->ahead.size)
+    {
+        void* state = realloc(tic80->ahead.state, size);
+        if(!state) return false;
+
+        tic80->ahead.state = state;
+        tic80->ahead.size = size;
+        size = tic_core_save_state(memory, state, size);
+    }
+
+    if(!size)
+        return false;
+
+    s32 top = tic->screen_dirty.top, bottom = tic->screen_dirty.bottom;
+    u64 counter = tic80->tickCounter;
+
+    tic_core_sound(memory, false);
+    tic80->tickData.trace = onTraceAhead;
+    tic80->tickData.error = onErrorAhead;
+    tic80->tickData.exit = onExitAhead;
+
+    for(s32 i = 0; i < frames; i++)
+        tick(tic80, input, i == frames - 1);
+
+    tic80->tickData.trace = onTrace;
+    tic80->tickData.error = onError;
+    tic80->tickData.exit = onExit;
+    tic_core_sound(memory, true);
+
+    tic80->tickCounter = counter;
+
+    // the script can't go back, the machine does and run ahead stays off from now on
+    if(!tic_core_load_state(memory, &tic80->tickData, tic80->ahead.state, size))
+    {
+        tic80->ahead.off = true;
+
+        if(tic_core_load_state_ram(memory, &tic80->tickData, tic80->ahead.state, size))
+        {
+            tic_core_blit_ex(memory, memory->screen_format, NULL, NULL, NULL);
+
+            tic->screen_dirty.top = 0;
+            tic->screen_dirty.bottom = TIC80_FULLHEIGHT;
+        }
+
+        return false;
+    }
+
+    // the frame shown since the last call changed the rows of both blits
+    if(top < bottom)
+    {
+        tic->screen_dirty.top = tic->screen_dirty.top < tic->screen_dirty.bottom ? MIN(top, tic->screen_dirty.top) : top;
+        tic->screen_dirty.bottom = MAX(bottom, tic->screen_dirty.bottom);
+    }
+
+    return true;
 }
 
 TIC80_API void tic80_delete(tic80* tic)
@@ -132,5 +337,7 @@ TIC80_API void tic80_delete(tic80* tic)
 
     tic_core_close(tic80->memory);
 
+    free(tic80->ahead.state);
+
     free(tic80);
 }
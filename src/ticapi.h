@@ -25,7 +25,8 @@
 #include "tic.h"
 
 typedef struct { u8 index; tic_flip flip; tic_rotate rotate; } RemapResult;
-typedef void(*RemapFunc)(void*, s32 x, s32 y, RemapResult* result);
+// called once per run of visible map cells in a row, starting at map cell x, y
+typedef void(*RemapFunc)(void*, s32 x, s32 y, s32 count, RemapResult* result);
 
 typedef void(*TraceOutput)(void*, const char*, u8 color);
 typedef void(*ErrorOutput)(void*, const char*);
@@ -39,8 +40,8 @@ typedef struct
     ExitCallback exit;
     CheckForceExit forceExit;
     
-    u64 (*counter)();
-    u64 (*freq)();
+    u64 (*counter)(void*);
+    u64 (*freq)(void*);
     u64 start;
 
     void* data;
@@ -71,6 +72,9 @@ typedef struct
 
     const tic_outline_item* (*getOutline)(const char* code, s32* size);
     void (*eval)(tic_mem* tic, const char* code);
+    // returns the size the script state needs and writes it only when it fits, 0 if it can't be saved
+    s32 (*save)(tic_mem* tic, void* buffer, s32 size);
+    bool (*load)(tic_mem* tic, const void* buffer, s32 size);
 
     const char* blockCommentStart;
     const char* blockCommentEnd;
@@ -137,10 +141,14 @@ typedef struct
 TIC_API_LIST(TIC_API_DEF)
 #undef TIC_API_DEF
 
+// textri over a list of triangles, each one is x1,y1,x2,y2,x3,y3,u1,v1,u2,v2,u3,v3
+#define TIC_TEXTRI_FLOATS 12
+void tic_api_textri_list(tic_mem* memory, const float* triangles, s32 count, bool use_map, u8* colors, s32 chroma);
+
 struct tic_mem
 {
     tic_ram             ram;
-    tic_cartridge       cart;
+    tic_cartridge*      cart;
 
     char saveid[TIC_SAVEID_SIZE];
 
@@ -168,6 +176,13 @@ struct tic_mem
     u32 screen[TIC80_FULLWIDTH * TIC80_FULLHEIGHT];
 #endif
     tic80_pixel_color_format screen_format;
+
+    // rows of screen rewritten by the last blit, none when top == bottom
+    struct
+    {
+        s32 top;
+        s32 bottom;
+    } screen_dirty;
 };
 
 tic_mem* tic_core_create(s32 samplerate);
@@ -179,11 +194,60 @@ void tic_core_tick(tic_mem* memory, tic_tick_data* data);
 void tic_core_tick_end(tic_mem* memory);
 void tic_core_blit(tic_mem* tic, tic80_pixel_color_format fmt);
 void tic_core_blit_ex(tic_mem* tic, tic80_pixel_color_format fmt, tic_scanline scanline, tic_overline overline, void* data);
+// runs the scanline and overline callbacks of a blit without converting the screen, rows stay dirty
+void tic_core_blit_skip(tic_mem* tic, tic80_pixel_color_format fmt);
 const tic_script_config* tic_core_script_config(tic_mem* memory);
+// call it after writing to tic_mem.ram directly, bypassing tic_api_poke/memcpy/memset
+void tic_core_invalidate(tic_mem* memory, s32 address, s32 size);
+// call it before reading tic_mem.ram directly, bypassing tic_api_peek/memcpy
+void tic_core_materialize(tic_mem* memory, s32 address, s32 size);
+// sync only points sections at a cart bank, they're copied into ram when it's accessed directly;
+// the cart must not change behind the core while it's on
+void tic_core_map_banks(tic_mem* memory, bool enabled);
+// draw into an unpacked 8bpp framebuffer, VRAM screen is repacked on peek or blit
+void tic_core_shadow(tic_mem* memory, bool enabled);
+// record draw calls during the tick and rasterize them on worker threads, 0 draws right away
+void tic_core_deferred(tic_mem* memory, s32 threads);
+// skip sound synthesis for instances nobody listens to, the samples buffer stays silent
+void tic_core_sound(tic_mem* memory, bool enabled);
+// up to frames of sound registers are queued for tic_core_synth instead of synthesizing in tick end, 0 turns it off;
+// returns the previous limit
+s32 tic_core_audio_thread(tic_mem* memory, s32 frames);
+// renders count stereo samples from the queued frames, the only call meant for the audio thread
+void tic_core_synth(tic_mem* memory, s16* samples, s32 count);
+// samples queued and not rendered yet, and the times the audio thread found no frame to play
+s32 tic_core_audio_queued(tic_mem* memory);
+s32 tic_core_audio_underruns(tic_mem* memory);
+// queued frames play rate / TIC_AUDIO_RATE times as fast, frontends nudge it to hold their latency
+#define TIC_AUDIO_RATE 10000
+void tic_core_audio_rate(tic_mem* memory, s32 rate);
+// gets the count stereo samples of every frame rendered, they're only valid during the call
+typedef void(*tic_sound_output)(void* data, const s16* samples, s32 count);
+// render a sfx or a music track from ram as fast as it goes, without video or the audio queue, handing the samples
+// to output frame by frame; returns the length in samples. Whatever was playing is stopped, channels masks the music
+// channels that are heard
+s32 tic_core_render_sfx(tic_mem* memory, s32 index, tic_sound_output output, void* data);
+s32 tic_core_render_music(tic_mem* memory, s32 track, bool sustain, u8 channels, tic_sound_output output, void* data);
+// run a cart image shared read only with other instances, it must outlive them; NULL gives back a private cart
+void tic_core_share_cart(tic_mem* memory, const tic_cartridge* cart);
+// returns the size of the machine state and writes it only when it fits the buffer, 0 if it can't be saved
+s32 tic_core_save_state(tic_mem* memory, void* buffer, s32 size);
+bool tic_core_load_state(tic_mem* memory, tic_tick_data* data, const void* buffer, s32 size);
+// restores the ram and the machine state of a snapshot but leaves the script as it is
+bool tic_core_load_state_ram(tic_mem* memory, tic_tick_data* data, const void* buffer, s32 size);
 
 typedef struct
 {
     tic80 tic;
     tic_mem* memory;
     tic_tick_data tickData;
+    u64 tickCounter;
+
+    // machine state kept while the screen is ticked ahead
+    struct
+    {
+        void* state;
+        s32 size;
+        bool off;
+    } ahead;
 } tic80_local;
@@ -24,6 +24,9 @@
 #include "tilesheet.h"
 #include "machine.h"
 
+#include <stddef.h>
+#include <string.h>
+
 static const tic_blit_segment segments[] = {
 //   +page +nb_pages 
 //   |  +bank +bank_size
@@ -91,3 +94,120 @@ tic_tileptr getTile(const tic_tilesheet* sheet, s32 index, bool local)
 
     return (tic_tileptr){segment, offset, ptr};
 }
+
+static tic_tilecache_format getTileCacheFormat(const tic_blit_segment* segment)
+{
+    if(segment->ptr_size == TIC_SPRITESIZE)
+        return tic_tilecache_font;
+
+    switch(segment->nb_pages)
+    {
+    case 1: return tic_tilecache_4bpp;
+    case 2: return tic_tilecache_2bpp;
+    default: return tic_tilecache_1bpp;
+    }
+}
+
+void initTileCache(tic_tilecache* cache, tic_ram* ram)
+{
+    memset(cache, 0, sizeof(tic_tilecache));
+
+    cache->tiles = ram->tiles.data->data;
+    cache->font = ram->font.data;
+}
+
+void freeTileCache(tic_tilecache* cache)
+{
+    for(s32 i = 0; i < tic_tilecache_formats; i++)
+    {
+        free(cache->formats[i].pixels);
+        cache->formats[i].pixels = NULL;
+    }
+}
+
+static void invalidateBlocks(bool* valid, s32 address, s32 size, s32 origin, s32 blockSize)
+{
+    s32 first = MAX(address - origin, 0) / blockSize;
+    s32 last = MIN(address + size - origin, TIC_TILECACHE_BLOCKS * blockSize);
+
+    if(last > 0)
+        for(s32 i = first, count = (last + blockSize - 1) / blockSize; i < count; i++)
+            valid[i] = false;
+}
+
+void invalidateTileCache(tic_tilecache* cache, s32 address, s32 size)
+{
+    if(size <= 0) return;
+
+    for(s32 i = tic_tilecache_4bpp; i < tic_tilecache_formats; i++)
+        invalidateBlocks(cache->formats[i].valid, address, size, offsetof(tic_ram, tiles), sizeof(tic_tile));
+
+    invalidateBlocks(cache->formats[tic_tilecache_font].valid, address, size, offsetof(tic_ram, font), TIC_SPRITESIZE);
+}
+
+static void decodeTile(const tic_tileptr* tile, u8* pixels)
+{
+    for(s32 i = 0; i < TIC_SPRITESIZE * TIC_SPRITESIZE; i++)
+        pixels[i] = getTilePixel(tile, i % TIC_SPRITESIZE, i / TIC_SPRITESIZE);
+}
+
+const u8* getTileCachePixels(tic_tilecache* cache, const tic_tileptr* tile, u8* scratch)
+{
+    enum {TileSize = TIC_SPRITESIZE * TIC_SPRITESIZE};
+
+    const tic_blit_segment* segment = tile->segment;
+    tic_tilecache_format format = getTileCacheFormat(segment);
+    const u8* base = format == tic_tilecache_font ? cache->font : cache->tiles;
+
+    // sheets outside of the ram are decoded on the fly
+    if(tile->ptr < base || tile->ptr >= base + TIC_TILECACHE_BLOCKS * segment->ptr_size)
+    {
+        decodeTile(tile, scratch);
+        return scratch;
+    }
+
+    s32 block = (s32)((tile->ptr - base) / segment->ptr_size);
+    s32 tiles = segment->nb_pages;
+
+    if(!cache->formats[format].pixels)
+    {
+        cache->formats[format].pixels = malloc(TIC_TILECACHE_BLOCKS * tiles * TileSize);
+
+        if(!cache->formats[format].pixels)
+        {
+            decodeTile(tile, scratch);
+            return scratch;
+        }
+
+        memset(cache->formats[format].valid, 0, sizeof cache->formats[format].valid);
+    }
+
+    u8* pixels = cache->formats[format].pixels + block * tiles * TileSize;
+
+    if(!cache->formats[format].valid[block])
+    {
+        for(s32 i = 0; i < tiles; i++)
+            decodeTile(&(tic_tileptr){segment, i * TIC_SPRITESIZE, tile->ptr}, pixels + i * TileSize);
+
+        cache->formats[format].valid[block] = true;
+    }
+
+    return pixels + tile->offset / TIC_SPRITESIZE * TileSize;
+}
+
+bool prepareTileCache(tic_tilecache* cache, const tic_blit_segment* segment)
+{
+    u8 scratch[TIC_SPRITESIZE * TIC_SPRITESIZE];
+    const u8* base = getTileCacheFormat(segment) == tic_tilecache_font ? cache->font : cache->tiles;
+
+    for(s32 i = 0; i < TIC_TILECACHE_BLOCKS; i++)
+    {
+        tic_tileptr tile = {segment, 0, (u8*)base + i * segment->ptr_size};
+
+        // scratch is only returned when the cache can't be allocated
+        if(getTileCachePixels(cache, &tile, scratch) == scratch)
+            return false;
+    }
+
+    return true;
+}
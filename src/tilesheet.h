@@ -52,9 +52,43 @@ typedef struct
     u8* ptr;
 } tic_tileptr;
 
+typedef enum
+{
+    tic_tilecache_font,
+    tic_tilecache_4bpp,
+    tic_tilecache_2bpp,
+    tic_tilecache_1bpp,
+
+    tic_tilecache_formats
+} tic_tilecache_format;
+
+#define TIC_TILECACHE_BLOCKS (TIC_BANK_SPRITES * TIC_SPRITE_BANKS)
+
+// tiles expanded to one byte per pixel, grouped by blit segment format
+typedef struct
+{
+    const u8* tiles;
+    const u8* font;
+
+    struct
+    {
+        u8* pixels;
+        bool valid[TIC_TILECACHE_BLOCKS];
+    } formats[tic_tilecache_formats];
+} tic_tilecache;
+
 tic_tilesheet getTileSheet(u8 segment, u8* ptr);
 tic_tileptr getTile(const tic_tilesheet* sheet, s32 index, bool local);
 
+void initTileCache(tic_tilecache* cache, tic_ram* ram);
+void freeTileCache(tic_tilecache* cache);
+void invalidateTileCache(tic_tilecache* cache, s32 address, s32 size);
+// tiles the cache doesn't hold are decoded into the caller's scratch of TIC_SPRITESIZE^2 bytes,
+// so threads drawing at once never share it
+const u8* getTileCachePixels(tic_tilecache* cache, const tic_tileptr* tile, u8* scratch);
+// decodes every tile of the segment ahead, so the cache can be read from several threads
+bool prepareTileCache(tic_tilecache* cache, const tic_blit_segment* segment);
+
 inline u8 getTileSheetPixel(const tic_tilesheet* sheet, s32 x, s32 y)
 {
     // tile coord
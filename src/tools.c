@@ -92,10 +92,8 @@ u32 tic_tool_find_closest_color(const tic_rgb* palette, const gif_color* color)
     return closetColor;
 }
 
-u32* tic_tool_palette_blit(const tic_palette* srcpal, tic80_pixel_color_format fmt)
+void tic_tool_palette_blit(u32* pal, const tic_palette* srcpal, tic80_pixel_color_format fmt)
 {
-    static u32 pal[TIC_PALETTE_SIZE];
-
     const tic_rgb* src = srcpal->colors;
     const tic_rgb* end = src + TIC_PALETTE_SIZE;
     u8* dst = (u8*)pal;
@@ -130,8 +128,6 @@ u32* tic_tool_palette_blit(const tic_palette* srcpal, tic80_pixel_color_format f
         }
         src++;
     }
-
-    return pal;
 }
 
 bool tic_tool_has_ext(const char* name, const char* ext)
@@ -81,6 +81,7 @@ static void tick(World* world)
     if(keyWasPressed(tic_key_tab)) setStudioMode(TIC_MAP_MODE);
 
     memcpy(&world->tic->ram.vram, world->preview, PREVIEW_SIZE);
+    tic_core_invalidate(world->tic, offsetof(tic_ram, vram), PREVIEW_SIZE);
 }
 
 static void scanline(tic_mem* tic, s32 row, void* data)
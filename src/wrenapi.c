@@ -32,14 +32,6 @@
 #include "tools.h"
 #include "wren.h"
 
-static WrenHandle* game_class;
-static WrenHandle* new_handle;
-static WrenHandle* update_handle;
-static WrenHandle* scanline_handle;
-static WrenHandle* overline_handle;
-
-static bool loaded = false;
-
 static char const* tic_wren_api = "\n\
 class TIC {\n\
     foreign static btn(id)\n\
@@ -200,15 +192,15 @@ static void closeWren(tic_mem* tic)
     if(machine->wren)
     {   
         // release handles
-        if (loaded)
+        if (machine->wrenHandles.loaded)
         {
-            wrenReleaseHandle(machine->wren, new_handle);
-            wrenReleaseHandle(machine->wren, update_handle);
-            wrenReleaseHandle(machine->wren, scanline_handle);
-            wrenReleaseHandle(machine->wren, overline_handle);
-            if (game_class != NULL) 
+            wrenReleaseHandle(machine->wren, machine->wrenHandles.new_handle);
+            wrenReleaseHandle(machine->wren, machine->wrenHandles.update_handle);
+            wrenReleaseHandle(machine->wren, machine->wrenHandles.scanline_handle);
+            wrenReleaseHandle(machine->wren, machine->wrenHandles.overline_handle);
+            if (machine->wrenHandles.game_class != NULL) 
             {
-                wrenReleaseHandle(machine->wren, game_class);
+                wrenReleaseHandle(machine->wren, machine->wrenHandles.game_class);
             }
         }
 
@@ -216,7 +208,7 @@ static void closeWren(tic_mem* tic)
         machine->wren = NULL;
 
     }
-    loaded = false;
+    machine->wrenHandles.loaded = false;
 }
 
 static tic_machine* getWrenMachine(WrenVM* vm)
@@ -247,7 +239,7 @@ static void wren_mgeti(WrenVM* vm)
     }
 
     tic_mem* tic = (tic_mem*)getWrenMachine(vm);
-    wrenSetSlotDouble(vm, 0, *(tic->ram.map.data + index));
+    wrenSetSlotDouble(vm, 0, tic_api_mget(tic, index % TIC_MAP_WIDTH, index / TIC_MAP_WIDTH));
 }
 
 static void wren_spritesize(WrenVM* vm)
@@ -501,7 +493,7 @@ static void wren_spr(WrenVM* vm)
     s32 scale = 1;
     tic_flip flip = tic_no_flip;
     tic_rotate rotate = tic_no_rotate;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     if(top > 1) 
@@ -576,7 +568,7 @@ static void wren_spr_internal(WrenVM* vm)
     s32 x = getWrenNumber(vm, 2);
     s32 y = getWrenNumber(vm, 3);
 
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
             
     if(isList(vm, 4))
@@ -621,7 +613,7 @@ static void wren_map(WrenVM* vm)
     s32 sx = 0;
     s32 sy = 0;
     s32 scale = 1;
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
 
     s32 top = wrenGetSlotCount(vm);
@@ -715,7 +707,7 @@ static void wren_textri(WrenVM* vm)
     }
 
     tic_mem* tic = (tic_mem*)getWrenMachine(vm);
-    static u8 colors[TIC_PALETTE_SIZE];
+    u8 colors[TIC_PALETTE_SIZE];
     s32 count = 0;
     bool use_map = false;
 
@@ -998,7 +990,8 @@ static void wren_sfx(WrenVM* vm)
 
         if (index >= 0)
         {
-            tic_sample* effect = tic->ram.sfx.samples.data + index;
+            tic_core_materialize(tic, offsetof(tic_ram, sfx.samples) + index * sizeof(tic_sample), sizeof(tic_sample));
+            const tic_sample* effect = tic->ram.sfx.samples.data + index;
 
             note = effect->note;
             octave = effect->octave;
@@ -1373,32 +1366,32 @@ static bool initWren(tic_mem* tic, const char* code)
         return false;
     }
 
-    loaded = true;
+    machine->wrenHandles.loaded = true;
 
     // make handles
     wrenEnsureSlots(vm, 1);
     wrenGetVariable(vm, "main", "Game", 0);
-    game_class = wrenGetSlotHandle(vm, 0); // handle from game class 
+    machine->wrenHandles.game_class = wrenGetSlotHandle(vm, 0); // handle from game class 
 
-    new_handle = wrenMakeCallHandle(vm, "new()");
-    update_handle = wrenMakeCallHandle(vm, TIC_FN "()");
-    scanline_handle = wrenMakeCallHandle(vm, SCN_FN "(_)");
-    overline_handle = wrenMakeCallHandle(vm, OVR_FN "()");
+    machine->wrenHandles.new_handle = wrenMakeCallHandle(vm, "new()");
+    machine->wrenHandles.update_handle = wrenMakeCallHandle(vm, TIC_FN "()");
+    machine->wrenHandles.scanline_handle = wrenMakeCallHandle(vm, SCN_FN "(_)");
+    machine->wrenHandles.overline_handle = wrenMakeCallHandle(vm, OVR_FN "()");
 
     // create game class
-    if (game_class)
+    if (machine->wrenHandles.game_class)
     {
         wrenEnsureSlots(vm, 1);
-        wrenSetSlotHandle(vm, 0, game_class);
-        wrenCall(vm, new_handle);
-        wrenReleaseHandle(machine->wren, game_class); // release game class handle
-        game_class = NULL;
+        wrenSetSlotHandle(vm, 0, machine->wrenHandles.game_class);
+        wrenCall(vm, machine->wrenHandles.new_handle);
+        wrenReleaseHandle(machine->wren, machine->wrenHandles.game_class); // release game class handle
+        machine->wrenHandles.game_class = NULL;
         if (wrenGetSlotCount(vm) == 0) 
         {
             machine->data->error(machine->data->data, "Error in game class :(");
             return false;
         }
-        game_class = wrenGetSlotHandle(vm, 0); // handle from game object 
+        machine->wrenHandles.game_class = wrenGetSlotHandle(vm, 0); // handle from game object 
     } else {
         machine->data->error(machine->data->data, "'Game class' isn't found :(");   
         return false;
@@ -1412,11 +1405,11 @@ static void callWrenTick(tic_mem* tic)
     tic_machine* machine = (tic_machine*)tic;
     WrenVM* vm = machine->wren;
 
-    if(vm && game_class)
+    if(vm && machine->wrenHandles.game_class)
     {
         wrenEnsureSlots(vm, 1);
-        wrenSetSlotHandle(vm, 0, game_class);
-        wrenCall(vm, update_handle);
+        wrenSetSlotHandle(vm, 0, machine->wrenHandles.game_class);
+        wrenCall(vm, machine->wrenHandles.update_handle);
     }
 }
 
@@ -1425,12 +1418,12 @@ static void callWrenScanline(tic_mem* tic, s32 row, void* data)
     tic_machine* machine = (tic_machine*)tic;
     WrenVM* vm = machine->wren;
 
-    if(vm && game_class)
+    if(vm && machine->wrenHandles.game_class)
     {
         wrenEnsureSlots(vm, 2);
-        wrenSetSlotHandle(vm, 0, game_class);
+        wrenSetSlotHandle(vm, 0, machine->wrenHandles.game_class);
         wrenSetSlotDouble(vm, 1, row);
-        wrenCall(vm, scanline_handle);
+        wrenCall(vm, machine->wrenHandles.scanline_handle);
     }
 }
 
@@ -1439,11 +1432,11 @@ static void callWrenOverline(tic_mem* tic, void* data)
     tic_machine* machine = (tic_machine*)tic;
     WrenVM* vm = machine->wren;
 
-    if (vm && game_class)
+    if (vm && machine->wrenHandles.game_class)
     {
         wrenEnsureSlots(vm, 1);
-        wrenSetSlotHandle(vm, 0, game_class);
-        wrenCall(vm, overline_handle);
+        wrenSetSlotHandle(vm, 0, machine->wrenHandles.game_class);
+        wrenCall(vm, machine->wrenHandles.overline_handle);
     }
 }
 
@@ -0,0 +1,90 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// ticks a batch of instances with 1 up to N cores and prints the instance frames per second
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "tic80.h"
+#include "jobs.h"
+#include "bench.h"
+#include "testcart.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {Instances = 64, Frames = 60};
+
+int main(int argc, char** argv)
+{
+    s32 cores = argc > 1 ? atoi(argv[1]) : tic_jobs_cores();
+    if(cores < 1) cores = 1;
+
+    u8* buffer = malloc(sizeof(tic_cartridge));
+    s32 size = buffer ? saveTestCart(buffer) : 0;
+
+    if(!size)
+        return 1;
+
+    tic80_cart* shared = tic80_cart_create(buffer, size);
+
+    tic80* tics[Instances];
+    tic80_input inputs[Instances];
+
+    memset(inputs, 0, sizeof inputs);
+
+    for(s32 i = 0; i < Instances; i++)
+    {
+        if(!(tics[i] = tic80_create(44100)))
+            return 1;
+
+        tic80_load_cart(tics[i], shared);
+    }
+
+    double single = 0;
+
+    for(s32 count = 1; count <= cores; count++)
+    {
+        tic80_batch* batch = tic80_batch_create(count - 1);
+
+        double start = benchTime();
+        tic80_batch_tick(batch, tics, inputs, NULL, Instances, Frames);
+        double fps = Instances * Frames / (benchTime() - start);
+
+        if(count == 1) single = fps;
+
+        printf("%2i cores: %8.0f instance frames/s, %5.2fx\n", count, fps, fps / single);
+
+        tic80_batch_delete(batch);
+    }
+
+    for(s32 i = 0; i < Instances; i++)
+        tic80_delete(tics[i]);
+
+    tic80_cart_delete(shared);
+
+    free(buffer);
+
+    return 0;
+}
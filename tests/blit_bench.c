@@ -0,0 +1,90 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// blits a full screen on every core at once and prints the frames per second,
+// in total and per core, from one core up to all of them
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "ticapi.h"
+#include "jobs.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+enum {Frames = 2000};
+
+static void blitJob(void* data, s32 index)
+{
+    tic_mem* tic = ((tic_mem**)data)[index];
+
+    for(s32 i = 0; i < Frames; i++)
+    {
+        // every row is dirty, so nothing is skipped as clean
+        tic->ram.vram.screen.data[0] = i;
+        tic_core_invalidate(tic, offsetof(tic_ram, vram.screen), sizeof(tic_screen));
+        tic_core_blit(tic, TIC80_PIXEL_COLOR_RGBA8888);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    s32 cores = argc > 1 ? atoi(argv[1]) : tic_jobs_cores();
+    if(cores < 1) cores = 1;
+
+    tic_mem** tics = calloc(cores, sizeof(tic_mem*));
+
+    for(s32 i = 0; i < cores; i++)
+    {
+        tic_mem* tic = tics[i] = tic_core_create(44100);
+
+        if(!tic) return 1;
+
+        for(s32 p = 0; p < sizeof(tic_screen); p++)
+            tic->ram.vram.screen.data[p] = p * 7;
+
+        tic_core_invalidate(tic, offsetof(tic_ram, vram.screen), sizeof(tic_screen));
+    }
+
+    for(s32 count = 1; count <= cores; count++)
+    {
+        tic_jobs* jobs = tic_jobs_create(count - 1);
+
+        double start = benchTime();
+        tic_jobs_run(jobs, blitJob, tics, count);
+        double fps = count * Frames / (benchTime() - start);
+
+        printf("%2i cores: %8.0f blits/s, %8.0f per core\n", count, fps, fps / count);
+
+        tic_jobs_close(jobs);
+    }
+
+    for(s32 i = 0; i < cores; i++)
+        tic_core_close(tics[i]);
+
+    free(tics);
+
+    return 0;
+}
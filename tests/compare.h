@@ -0,0 +1,156 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// scaffold of the tests that draw with the core and with a reference of the
+// baseline path on a second machine, then compare the two screens
+
+#pragma once
+
+#include "ticapi.h"
+#include "tools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+// draws one call on both machines and describes it in info,
+// returns false when the call itself already came out different
+typedef bool(*CompareDraw)(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size);
+
+static inline u8 tilePixel(tic_mem* tic, s32 index, s32 x, s32 y)
+{
+    const tic_tile* tile = index < TIC_BANK_SPRITES
+        ? &tic->ram.tiles.data[index]
+        : &tic->ram.sprites.data[index - TIC_BANK_SPRITES];
+
+    return tic_tool_peek4(tile->data, x + y * TIC_SPRITESIZE);
+}
+
+static inline bool isTransparent(u8 color, const u8* colors, s32 count)
+{
+    for(s32 i = 0; i < count; i++)
+        if(colors[i] == color)
+            return true;
+
+    return false;
+}
+
+// orientation bits and pixel walk of the baseline drawTile, a scale x scale rect per source pixel
+static inline void referenceTile(tic_mem* tic, s32 index, s32 x, s32 y, const u8* colors, s32 count, s32 scale, tic_flip flip, tic_rotate rotate)
+{
+    u32 orientation = flip & 0b11;
+
+    if(rotate == tic_90_rotate) orientation ^= 0b001;
+    else if(rotate == tic_180_rotate) orientation ^= 0b011;
+    else if(rotate == tic_270_rotate) orientation ^= 0b010;
+    if(rotate == tic_90_rotate || rotate == tic_270_rotate) orientation |= 0b100;
+
+    for(s32 py = 0; py < TIC_SPRITESIZE; py++)
+        for(s32 px = 0; px < TIC_SPRITESIZE; px++)
+        {
+            s32 ix = orientation & 0b001 ? TIC_SPRITESIZE - 1 - px : px;
+            s32 iy = orientation & 0b010 ? TIC_SPRITESIZE - 1 - py : py;
+
+            if(orientation & 0b100)
+            {
+                s32 t = ix; ix = iy; iy = t;
+            }
+
+            u8 color = tilePixel(tic, index, ix, iy);
+
+            if(!isTransparent(color, colors, count))
+                tic_api_rect(tic, x + px * scale, y + py * scale, scale, scale, color);
+        }
+}
+
+static inline void randomize(tic_mem* tic, s32 address, s32 size)
+{
+    u8* ram = (u8*)&tic->ram + address;
+
+    for(s32 i = 0; i < size; i++)
+        ram[i] = rand();
+
+    tic_core_invalidate(tic, address, size);
+}
+
+static inline void screen(tic_mem* tic, u8* buffer)
+{
+    tic_core_materialize(tic, offsetof(tic_ram, vram.screen), sizeof(tic_screen));
+    memcpy(buffer, tic->ram.vram.screen.data, sizeof(tic_screen));
+}
+
+// runs the draws with the seed from the command line and compares the screens every hundred of them;
+// the sheet, font and map get new random bytes every thousand, the palette mapping too when it's asked for
+static inline s32 compareScreens(const char* name, const char* what, s32 iterations, bool mapping, s32 argc, char** argv, CompareDraw draw)
+{
+    tic_mem* fast = tic_core_create(44100);
+    tic_mem* reference = tic_core_create(44100);
+
+    if(!fast || !reference)
+        return 1;
+
+    srand(argc > 1 ? atoi(argv[1]) : 1);
+
+    s32 failed = 0;
+
+    for(s32 i = 0; i < iterations && !failed; i++)
+    {
+        char info[256] = {0};
+
+        if(i % 1000 == 0)
+        {
+            randomize(fast, offsetof(tic_ram, tiles), sizeof(tic_tiles) * 2);
+            randomize(fast, offsetof(tic_ram, font), sizeof(tic_font));
+            randomize(fast, offsetof(tic_ram, map), sizeof(tic_map));
+
+            if(mapping)
+                randomize(fast, offsetof(tic_ram, vram.mapping), sizeof fast->ram.vram.mapping);
+
+            memcpy(&reference->ram, &fast->ram, sizeof(tic_ram));
+            tic_core_invalidate(reference, 0, sizeof(tic_ram));
+        }
+
+        if(!draw(fast, reference, i, info, sizeof info))
+            failed = 1;
+        else if(i % 100 == 99)
+        {
+            static u8 a[sizeof(tic_screen)], b[sizeof(tic_screen)];
+            screen(fast, a);
+            screen(reference, b);
+
+            failed = memcmp(a, b, sizeof a) != 0;
+        }
+
+        if(failed)
+            printf("%s test failed at %i: %s\n", name, i, info);
+    }
+
+    tic_core_close(fast);
+    tic_core_close(reference);
+
+    if(!failed)
+        printf("%s test passed, %i %s\n", name, iterations, what);
+
+    return failed;
+}
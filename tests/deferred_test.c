@@ -0,0 +1,194 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// draws frames of random calls on a machine that records them and replays them
+// on worker threads at the end of the tick, and on one that draws them right away;
+// the frames switch the blit segment and write the sheet between calls and the
+// screens have to come out the same
+
+#include "compare.h"
+
+enum {Frames = 2000, Calls = 16, Threads = 3};
+
+static s32 coord(s32 size)
+{
+    return rand() % (size + 64) - 32;
+}
+
+static void drawCall(tic_mem* machines[2], s32 call, char* info, s32 size)
+{
+    u8 color = rand() % TIC_PALETTE_SIZE;
+    s32 x = coord(TIC80_WIDTH), y = coord(TIC80_HEIGHT);
+    s32 a = coord(TIC80_WIDTH), b = coord(TIC80_HEIGHT);
+
+    switch(call)
+    {
+    case 0:
+        {
+            s32 w = rand() % 64, h = rand() % 64;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_clip(machines[m], x, y, w, h);
+
+            snprintf(info, size, "clip(%i, %i, %i, %i)", x, y, w, h);
+        }
+        break;
+    case 1:
+        for(s32 m = 0; m < 2; m++)
+            tic_api_rect(machines[m], x, y, a - x, b - y, color);
+
+        snprintf(info, size, "rect(%i, %i, %i, %i)", x, y, a - x, b - y);
+        break;
+    case 2:
+        for(s32 m = 0; m < 2; m++)
+            tic_api_line(machines[m], x, y, a, b, color);
+
+        snprintf(info, size, "line(%i, %i, %i, %i)", x, y, a, b);
+        break;
+    case 3:
+        {
+            s32 c = coord(TIC80_WIDTH), d = coord(TIC80_HEIGHT);
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_tri(machines[m], x, y, a, b, c, d, color);
+
+            snprintf(info, size, "tri(%i, %i, %i, %i, %i, %i)", x, y, a, b, c, d);
+        }
+        break;
+    case 4:
+        {
+            float pt[TIC_TEXTRI_FLOATS];
+
+            for(s32 i = 0; i < 6; i += 2)
+            {
+                pt[i] = coord(TIC80_WIDTH);
+                pt[i + 1] = coord(TIC80_HEIGHT);
+            }
+
+            for(s32 i = 6; i < TIC_TEXTRI_FLOATS; i++)
+                pt[i] = rand() % 256;
+
+            bool useMap = rand() & 1;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_textri(machines[m], pt[0], pt[1], pt[2], pt[3], pt[4], pt[5], 
+                    pt[6], pt[7], pt[8], pt[9], pt[10], pt[11], useMap, &color, 1);
+
+            snprintf(info, size, "textri(%.0f, %.0f, %.0f, %.0f, %.0f, %.0f) map %i", pt[0], pt[1], pt[2], pt[3], pt[4], pt[5], useMap);
+        }
+        break;
+    case 5:
+        {
+            s32 index = rand() % (TIC_BANK_SPRITES * 2), w = 1 + rand() % 3, h = 1 + rand() % 3;
+            s32 scale = 1 + rand() % 3;
+            tic_flip flip = rand() % 4;
+            tic_rotate rotate = rand() % 4;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_spr(machines[m], index, x, y, w, h, &color, 1, scale, flip, rotate);
+
+            snprintf(info, size, "spr(%i, %i, %i, %i, %i) scale %i flip %i rotate %i", index, x, y, w, h, scale, flip, rotate);
+        }
+        break;
+    case 6:
+        {
+            s32 mx = rand() % TIC_MAP_WIDTH, my = rand() % TIC_MAP_HEIGHT;
+            s32 w = rand() % 12, h = rand() % 12, scale = 1 + rand() % 2;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_map(machines[m], mx, my, w, h, x, y, &color, 1, scale, NULL, NULL);
+
+            snprintf(info, size, "map(%i, %i, %i, %i, %i, %i) scale %i", mx, my, w, h, x, y, scale);
+        }
+        break;
+    case 7:
+        {
+            bool fixed = rand() & 1, alt = rand() & 1;
+            s32 scale = 1 + rand() % 2;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_print(machines[m], "deferred\nTEST", x, y, color, fixed, scale, alt);
+
+            snprintf(info, size, "print at %i %i scale %i", x, y, scale);
+        }
+        break;
+    case 8:
+        {
+            // written straight to ram as the sprite editor does, the calls recorded so far keep their segment
+            u8 segment = 1 + rand() % 15;
+
+            for(s32 m = 0; m < 2; m++)
+                machines[m]->ram.vram.blit.segment = segment;
+
+            snprintf(info, size, "blit segment %i", segment);
+        }
+        break;
+    case 9:
+        {
+            s32 address = offsetof(tic_ram, tiles) + rand() % (sizeof(tic_tiles) * 2);
+            u8 value = rand();
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_poke(machines[m], address, value);
+
+            snprintf(info, size, "poke(%i, %i)", address, value);
+        }
+        break;
+    case 10:
+        if(rand() % 8 == 0)
+        {
+            for(s32 m = 0; m < 2; m++)
+                tic_api_cls(machines[m], color);
+
+            snprintf(info, size, "cls(%i)", color);
+        }
+        break;
+    }
+}
+
+static bool drawFrame(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    tic_mem* machines[] = {fast, reference};
+
+    if(i == 0)
+        tic_core_deferred(fast, Threads);
+
+    for(s32 m = 0; m < 2; m++)
+        tic_core_tick_start(machines[m]);
+
+    for(s32 c = 0; c < Calls; c++)
+        drawCall(machines, rand() % 11, info, size);
+
+    for(s32 m = 0; m < 2; m++)
+    {
+        machines[m]->ram.vram.blit.segment = 2;
+        tic_core_tick_end(machines[m]);
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("deferred", "frames", Frames, true, argc, argv, drawFrame);
+}
@@ -0,0 +1,147 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// draws lines, rect borders and circle outlines, most of them partly or fully
+// outside of the clip rect, and compares the screen with the baseline walks
+// of ticLine, drawRectBorder and circb, clipped pixel by pixel
+
+#include "compare.h"
+
+enum {Iterations = 20000};
+
+static void referenceLine(tic_mem* tic, s32 x0, s32 y0, s32 x1, s32 y1, u8 color)
+{
+    if(y0 > y1)
+    {
+        SWAP(x0, x1, s32);
+        SWAP(y0, y1, s32);
+    }
+
+    s32 dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    s32 dy = y1 - y0;
+    s32 err = (dx > dy ? dx : -dy) / 2, e2;
+
+    for(;;)
+    {
+        tic_api_pix(tic, x0, y0, color, false);
+        if (x0 == x1 && y0 == y1) break;
+        e2 = err;
+        if (e2 >-dx) { err -= dy; x0 += sx; }
+        if (e2 < dy) { err += dx; y0++; }
+    }
+}
+
+static void referenceRectBorder(tic_mem* tic, s32 x, s32 y, s32 width, s32 height, u8 color)
+{
+    for(s32 i = x; i < x + width; i++)
+    {
+        tic_api_pix(tic, i, y, color, false);
+        tic_api_pix(tic, i, y + height - 1, color, false);
+    }
+
+    for(s32 i = MAX(y, 0); i < MIN(y + height, TIC80_HEIGHT); i++)
+    {
+        tic_api_pix(tic, x, i, color, false);
+        tic_api_pix(tic, x + width - 1, i, color, false);
+    }
+}
+
+static void referenceCircleBorder(tic_mem* tic, s32 xm, s32 ym, s32 radius, u8 color)
+{
+    s32 r = radius;
+    s32 x = -r, y = 0, err = 2-2*r;
+    do {
+        tic_api_pix(tic, xm-x, ym+y, color, false);
+        tic_api_pix(tic, xm-y, ym-x, color, false);
+        tic_api_pix(tic, xm+x, ym-y, color, false);
+        tic_api_pix(tic, xm+y, ym+x, color, false);
+        r = err;
+        if (r <= y) err += ++y*2+1;
+        if (r > x || err > y) err += ++x*2+1;
+    } while (x < 0);
+}
+
+// mostly around the screen, now and then far out of it
+static s32 coord(s32 size)
+{
+    return rand() % 8 ? rand() % (size * 2) - size / 2 : rand() % (size * 8) - size * 4;
+}
+
+static bool drawOutline(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    s32 clipX = rand() % TIC80_WIDTH - 8, clipY = rand() % TIC80_HEIGHT - 8;
+    s32 clipW = rand() % 160, clipH = rand() % 120;
+
+    tic_api_clip(fast, clipX, clipY, clipW, clipH);
+    tic_api_clip(reference, clipX, clipY, clipW, clipH);
+
+    u8 color = rand() % TIC_PALETTE_SIZE;
+
+    switch(i % 3)
+    {
+    case 0:
+        {
+            s32 x0 = coord(TIC80_WIDTH), y0 = coord(TIC80_HEIGHT);
+            s32 x1 = coord(TIC80_WIDTH), y1 = coord(TIC80_HEIGHT);
+
+            // short, straight and diagonal lines take their own paths
+            if(rand() % 4 == 0) x1 = x0 + rand() % 5 - 2;
+            else if(rand() % 4 == 0) y1 = y0 + rand() % 5 - 2;
+            else if(rand() % 4 == 0) y1 = y0 + (x1 - x0);
+
+            tic_api_line(fast, x0, y0, x1, y1, color);
+            referenceLine(reference, x0, y0, x1, y1, color);
+            snprintf(info, size, "line(%i, %i, %i, %i)", x0, y0, x1, y1);
+        }
+        break;
+    case 1:
+        {
+            s32 x = coord(TIC80_WIDTH), y = coord(TIC80_HEIGHT);
+            s32 w = rand() % 300 - 10, h = rand() % 200 - 10;
+
+            tic_api_rectb(fast, x, y, w, h, color);
+            referenceRectBorder(reference, x, y, w, h, color);
+            snprintf(info, size, "rectb(%i, %i, %i, %i)", x, y, w, h);
+        }
+        break;
+    case 2:
+        {
+            s32 x = coord(TIC80_WIDTH), y = coord(TIC80_HEIGHT);
+            s32 r = rand() % 8 ? rand() % 64 : rand() % 400;
+
+            tic_api_circb(fast, x, y, r, color);
+            referenceCircleBorder(reference, x, y, r, color);
+            snprintf(info, size, "circb(%i, %i, %i)", x, y, r);
+        }
+        break;
+    }
+
+    snprintf(info + strlen(info), size - strlen(info), " clip %i %i %i %i", clipX, clipY, clipW, clipH);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("line", "outlines", Iterations, true, argc, argv, drawOutline);
+}
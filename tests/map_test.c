@@ -0,0 +1,100 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// draws the map with the row blitter and the batched remap callback and compares
+// the screen with the baseline drawMap, which wrapped and drew every cell one by one
+
+#include "compare.h"
+
+enum {Iterations = 20000};
+
+static void remapCell(s32 x, s32 y, RemapResult* result)
+{
+    result->index ^= x * 7 + y * 3;
+    result->flip = (x + y) & 3;
+    result->rotate = (x ^ y) & 3;
+}
+
+static void remapRow(void* data, s32 x, s32 y, s32 count, RemapResult* result)
+{
+    for(s32 i = 0; i < count; i++)
+        remapCell(x + i, y, result + i);
+}
+
+static void referenceMap(tic_mem* tic, s32 x, s32 y, s32 width, s32 height, s32 sx, s32 sy, const u8* colors, s32 count, s32 scale, bool remap)
+{
+    const s32 size = TIC_SPRITESIZE * scale;
+
+    for(s32 j = y, jj = sy; j < y + height; j++, jj += size)
+        for(s32 i = x, ii = sx; i < x + width; i++, ii += size)
+        {
+            s32 mi = i;
+            s32 mj = j;
+
+            while(mi < 0) mi += TIC_MAP_WIDTH;
+            while(mj < 0) mj += TIC_MAP_HEIGHT;
+            while(mi >= TIC_MAP_WIDTH) mi -= TIC_MAP_WIDTH;
+            while(mj >= TIC_MAP_HEIGHT) mj -= TIC_MAP_HEIGHT;
+
+            RemapResult retile = {tic->ram.map.data[mi + mj * TIC_MAP_WIDTH], tic_no_flip, tic_no_rotate};
+
+            if(remap)
+                remapCell(mi, mj, &retile);
+
+            referenceTile(tic, retile.index, ii, jj, colors, count, scale, retile.flip, retile.rotate);
+        }
+}
+
+static bool drawMap(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    s32 clipX = rand() % TIC80_WIDTH - 8, clipY = rand() % TIC80_HEIGHT - 8;
+    s32 clipW = rand() % 160, clipH = rand() % 120;
+
+    tic_api_clip(fast, clipX, clipY, clipW, clipH);
+    tic_api_clip(reference, clipX, clipY, clipW, clipH);
+
+    // map coordinates past both edges wrap around
+    s32 x = rand() % (TIC_MAP_WIDTH * 3) - TIC_MAP_WIDTH, y = rand() % (TIC_MAP_HEIGHT * 3) - TIC_MAP_HEIGHT;
+    s32 width = rand() % 12, height = rand() % 12;
+    s32 sx = rand() % (TIC80_WIDTH + 160) - 120, sy = rand() % (TIC80_HEIGHT + 120) - 90;
+    s32 scale = 1 + rand() % 3;
+    bool remap = rand() & 1;
+
+    u8 colors[3];
+    s32 count = rand() % (COUNT_OF(colors) + 1);
+    for(s32 c = 0; c < count; c++)
+        colors[c] = rand() % TIC_PALETTE_SIZE;
+
+    tic_api_map(fast, x, y, width, height, sx, sy, colors, count, scale, remap ? remapRow : NULL, NULL);
+    referenceMap(reference, x, y, width, height, sx, sy, colors, count, scale, remap);
+
+    snprintf(info, size, "map(%i, %i, %i, %i, %i, %i) scale %i remap %i clip %i %i %i %i",
+        x, y, width, height, sx, sy, scale, remap, clipX, clipY, clipW, clipH);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("map", "maps", Iterations, true, argc, argv, drawMap);
+}
@@ -0,0 +1,136 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// draws scaled tiles and text with the span blitter and compares the screen
+// with the old path, which filled a scale x scale rect per source pixel
+
+#include "compare.h"
+
+enum {Iterations = 20000};
+
+static u8 glyphPixel(tic_mem* tic, s32 sym, s32 x, s32 y)
+{
+    return tic_tool_peek1(tic->ram.font.data + sym * BITS_IN_BYTE, x + y * TIC_SPRITESIZE);
+}
+
+static bool isEmptyColumn(tic_mem* tic, s32 sym, s32 x)
+{
+    for(s32 y = 0; y < TIC_SPRITESIZE; y++)
+        if(glyphPixel(tic, sym, x, y))
+            return false;
+
+    return true;
+}
+
+// glyph trimming and advance of the baseline drawChar and drawText
+static s32 referenceText(tic_mem* tic, const char* text, s32 x, s32 y, u8 color, bool fixed, s32 scale, bool alt)
+{
+    s32 width = (alt ? TIC_ALTFONT_WIDTH : TIC_FONT_WIDTH) - (fixed ? 0 : 2);
+    s32 pos = x, max = x;
+
+    for(char sym; (sym = *text++);)
+    {
+        if(sym == '\n')
+        {
+            if(pos > max) max = pos;
+
+            pos = x;
+            y += TIC_FONT_HEIGHT * scale;
+            continue;
+        }
+
+        s32 index = alt * TIC_FONT_CHARS / 2 + sym;
+        s32 start = 0, end = TIC_SPRITESIZE;
+
+        if(!fixed)
+        {
+            while(start < end && isEmptyColumn(tic, index, start)) start++;
+            while(end > start && isEmptyColumn(tic, index, end - 1)) end--;
+        }
+
+        for(s32 col = start; col < end; col++)
+            for(s32 row = 0; row < TIC_SPRITESIZE; row++)
+                if(glyphPixel(tic, index, col, row))
+                    tic_api_rect(tic, pos + (col - start) * scale, y + row * scale, scale, scale, color);
+
+        s32 size = end - start;
+        pos += ((!fixed && size) ? size + 1 : width) * scale;
+    }
+
+    return pos > max ? pos - x : max - x;
+}
+
+static bool drawScaled(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    s32 clipX = rand() % TIC80_WIDTH - 8, clipY = rand() % TIC80_HEIGHT - 8;
+    s32 clipW = rand() % 96, clipH = rand() % 96;
+
+    tic_api_clip(fast, clipX, clipY, clipW, clipH);
+    tic_api_clip(reference, clipX, clipY, clipW, clipH);
+
+    s32 scale = 2 + rand() % 3;
+    s32 x = clipX + rand() % 96 - 48, y = clipY + rand() % 96 - 48;
+
+    snprintf(info, size, "scale %i at %i %i clip %i %i %i %i", scale, x, y, clipX, clipY, clipW, clipH);
+
+    if(i & 1)
+    {
+        s32 index = rand() % (TIC_BANK_SPRITES * 2);
+        tic_flip flip = rand() % 4;
+        tic_rotate rotate = rand() % 4;
+
+        u8 colors[3];
+        s32 count = rand() % (COUNT_OF(colors) + 1);
+        for(s32 c = 0; c < count; c++)
+            colors[c] = rand() % TIC_PALETTE_SIZE;
+
+        tic_api_spr(fast, index, x, y, 1, 1, colors, count, scale, flip, rotate);
+        referenceTile(reference, index, x, y, colors, count, scale, flip, rotate);
+    }
+    else
+    {
+        char text[8];
+        for(s32 c = 0; c < COUNT_OF(text) - 1; c++)
+            text[c] = rand() % 8 ? ' ' + rand() % ('~' - ' ' + 1) : '\n';
+        text[COUNT_OF(text) - 1] = '\0';
+
+        u8 color = rand() % TIC_PALETTE_SIZE;
+        bool fixed = rand() & 1, alt = rand() & 1;
+
+        s32 a = tic_api_print(fast, text, x, y, color, fixed, scale, alt);
+        s32 b = referenceText(reference, text, x, y, color, fixed, scale, alt);
+
+        if(a != b)
+        {
+            snprintf(info, size, "print width %i, expected %i", a, b);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("scale", "draws", Iterations, false, argc, argv, drawScaled);
+}
@@ -0,0 +1,78 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// renders all 64 sfx of a random sfx section, the way the studio exports them,
+// and prints the time per pass and how many times faster than real time it runs
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "ticapi.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+enum {Rounds = 20, Samplerate = 44100};
+
+// the samples are only counted, the time goes to the synthesis
+static void countSamples(void* data, const s16* samples, s32 count)
+{
+    *(s64*)data += count;
+}
+
+int main(int argc, char** argv)
+{
+    s32 rounds = argc > 1 ? atoi(argv[1]) : Rounds;
+    if(rounds < 1) rounds = 1;
+
+    tic_mem* tic = tic_core_create(Samplerate);
+
+    if(!tic)
+        return 1;
+
+    // every kind of envelope, a few waveforms left empty play as noise
+    u32 seed = 1;
+    for(s32 i = 0; i < sizeof(tic_sfx); i++)
+        ((u8*)&tic->ram.sfx)[i] = (seed = seed * 1103515245 + 12345) >> 16;
+
+    for(s32 i = 0; i < WAVES_COUNT; i += 5)
+        memset(&tic->ram.sfx.waveforms.items[i], 0, sizeof(tic_waveform));
+
+    tic_core_invalidate(tic, offsetof(tic_ram, sfx), sizeof(tic_sfx));
+
+    s64 total = 0;
+    double start = benchTime();
+
+    for(s32 round = 0; round < rounds; round++)
+        for(s32 i = 0; i < SFX_COUNT; i++)
+            tic_core_render_sfx(tic, i, countSamples, &total);
+
+    double time = benchTime() - start;
+
+    printf("%i sfx in %.2f ms, %.0fx real time\n", SFX_COUNT, time * 1000 / rounds, total / (double)Samplerate / time);
+
+    tic_core_close(tic);
+
+    return 0;
+}
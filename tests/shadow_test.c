@@ -0,0 +1,165 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// draws with the shadow framebuffer on and reads and writes the screen memory
+// between the draws, the same as a machine drawing to vram straight; every peek
+// has to return the same byte and the screens and blits have to be the same
+
+#include "compare.h"
+
+enum {Iterations = 20000};
+
+static s32 screenAddress()
+{
+    return offsetof(tic_ram, vram.screen) + rand() % sizeof(tic_screen);
+}
+
+static bool shadowCall(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    tic_mem* machines[] = {fast, reference};
+
+    if(i == 0)
+        tic_core_shadow(fast, true);
+
+    u8 color = rand() % TIC_PALETTE_SIZE;
+    s32 x = rand() % (TIC80_WIDTH + 32) - 16, y = rand() % (TIC80_HEIGHT + 32) - 16;
+    s32 w = rand() % 64, h = rand() % 64;
+
+    switch(rand() % 10)
+    {
+    case 0:
+        for(s32 m = 0; m < 2; m++)
+            tic_api_rect(machines[m], x, y, w, h, color);
+
+        snprintf(info, size, "rect(%i, %i, %i, %i)", x, y, w, h);
+        break;
+    case 1:
+        for(s32 m = 0; m < 2; m++)
+            tic_api_line(machines[m], x, y, x + w, y + h - 32, color);
+
+        snprintf(info, size, "line(%i, %i, %i, %i)", x, y, x + w, y + h - 32);
+        break;
+    case 2:
+        {
+            s32 index = rand() % (TIC_BANK_SPRITES * 2);
+            tic_flip flip = rand() % 4;
+            tic_rotate rotate = rand() % 4;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_spr(machines[m], index, x, y, 2, 2, &color, 1, 1, flip, rotate);
+
+            snprintf(info, size, "spr(%i, %i, %i) flip %i rotate %i", index, x, y, flip, rotate);
+        }
+        break;
+    case 3:
+        for(s32 m = 0; m < 2; m++)
+            tic_api_circ(machines[m], x, y, w / 2, color);
+
+        snprintf(info, size, "circ(%i, %i, %i)", x, y, w / 2);
+        break;
+    case 4:
+        {
+            s32 address = screenAddress();
+            u8 a = tic_api_peek(fast, address), b = tic_api_peek(reference, address);
+
+            snprintf(info, size, "peek(%i) is %i, expected %i", address, a, b);
+
+            if(a != b) return false;
+        }
+        break;
+    case 5:
+        {
+            s32 address = screenAddress() * 2 + rand() % 2;
+            u8 a = tic_api_peek4(fast, address), b = tic_api_peek4(reference, address);
+
+            snprintf(info, size, "peek4(%i) is %i, expected %i", address, a, b);
+
+            if(a != b) return false;
+        }
+        break;
+    case 6:
+        {
+            s32 address = screenAddress();
+            u8 value = rand();
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_poke(machines[m], address, value);
+
+            snprintf(info, size, "poke(%i, %i)", address, value);
+        }
+        break;
+    case 7:
+        {
+            s32 address = screenAddress() * 2 + rand() % 2;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_poke4(machines[m], address, color);
+
+            snprintf(info, size, "poke4(%i, %i)", address, color);
+        }
+        break;
+    case 8:
+        {
+            // screen to screen and between the screen and the map, overlapping or not
+            s32 count = rand() % 512;
+            s32 dst = rand() & 1 ? screenAddress() : offsetof(tic_ram, map) + rand() % 1024;
+            s32 src = rand() & 1 ? screenAddress() : offsetof(tic_ram, map) + rand() % 1024;
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_memcpy(machines[m], dst, src, count);
+
+            snprintf(info, size, "memcpy(%i, %i, %i)", dst, src, count);
+        }
+        break;
+    case 9:
+        {
+            s32 dst = screenAddress(), count = rand() % 512;
+            u8 value = rand();
+
+            for(s32 m = 0; m < 2; m++)
+                tic_api_memset(machines[m], dst, value, count);
+
+            snprintf(info, size, "memset(%i, %i, %i)", dst, value, count);
+        }
+        break;
+    }
+
+    if(i % 500 == 499)
+    {
+        for(s32 m = 0; m < 2; m++)
+            tic_core_blit(machines[m], TIC80_PIXEL_COLOR_RGBA8888);
+
+        if(memcmp(fast->screen, reference->screen, sizeof fast->screen))
+        {
+            snprintf(info, size, "blit");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("shadow", "calls", Iterations, true, argc, argv, shadowCall);
+}
@@ -0,0 +1,60 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// draws single tiles with the span blitter and compares the screen
+// with the old per pixel path, every flip, rotation, colorkey and clip
+
+#include "compare.h"
+
+enum {Iterations = 20000};
+
+static bool drawTile(tic_mem* fast, tic_mem* reference, s32 i, char* info, s32 size)
+{
+    s32 clipX = rand() % TIC80_WIDTH - 8, clipY = rand() % TIC80_HEIGHT - 8;
+    s32 clipW = rand() % 64, clipH = rand() % 64;
+
+    s32 index = rand() % (TIC_BANK_SPRITES * 2);
+    s32 x = clipX + rand() % 80 - 16, y = clipY + rand() % 80 - 16;
+    tic_flip flip = rand() % 4;
+    tic_rotate rotate = rand() % 4;
+
+    u8 colors[3];
+    s32 count = rand() % (COUNT_OF(colors) + 1);
+    for(s32 c = 0; c < count; c++)
+        colors[c] = rand() % TIC_PALETTE_SIZE;
+
+    tic_api_clip(fast, clipX, clipY, clipW, clipH);
+    tic_api_clip(reference, clipX, clipY, clipW, clipH);
+
+    tic_api_spr(fast, index, x, y, 1, 1, colors, count, 1, flip, rotate);
+    referenceTile(reference, index, x, y, colors, count, 1, flip, rotate);
+
+    snprintf(info, size, "spr(%i, %i, %i) flip %i rotate %i clip %i %i %i %i",
+        index, x, y, flip, rotate, clipX, clipY, clipW, clipH);
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    return compareScreens("sprite", "tiles", Iterations, true, argc, argv, drawTile);
+}
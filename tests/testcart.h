@@ -0,0 +1,67 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// the cart the tests that tick whole tic80 instances load: a lua script drawing
+// sprites, the map, a textured triangle and text and playing sfx every frame
+
+#pragma once
+
+#include "cart.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char TestScript[] =
+    "-- script: lua\n"
+    "t=0\n"
+    "function TIC()\n"
+    " cls(t%16)\n"
+    " for i=0,40 do spr(i,(i*37+t)%240,(i*13+t)%136,0,1+i%2,i%4,i%4) end\n"
+    " map(t%30,0,30,17,0,0,0)\n"
+    " textri(0,0,200,20,50,130,0,0,64,0,0,64,false,0)\n"
+    " print(\"test \"..t,10,10,t%16,false,2)\n"
+    " sfx(t%4,30,-1,t%4)\n"
+    " t=t+1\n"
+    "end\n";
+
+// saves the cart to buffer, which holds sizeof(tic_cartridge); returns its size, 0 when out of memory
+static s32 saveTestCart(u8* buffer)
+{
+    tic_cartridge* cart = calloc(1, sizeof(tic_cartridge));
+
+    if(!cart)
+        return 0;
+
+    strcpy(cart->code.data, TestScript);
+
+    for(s32 i = 0; i < sizeof(tic_tiles); i++)
+        ((u8*)&cart->bank0.tiles)[i] = i * 7;
+
+    for(s32 i = 0; i < sizeof(tic_map); i++)
+        cart->bank0.map.data[i] = i;
+
+    s32 size = tic_cart_save(cart, buffer);
+    free(cart);
+
+    return size;
+}
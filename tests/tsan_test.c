@@ -0,0 +1,136 @@
+// MIT License
+
+// Copyright (c) 2017 Vadim Grigoruk @nesbox // grigoruk@gmail.com
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// ticks many tic80 instances on threads at once, every one drawing, playing sound
+// and saving its state; built with -DBUILD_TSAN_TEST=ON, ThreadSanitizer reports
+// whatever the instances still share without synchronization
+
+#include "tic80.h"
+#include "jobs.h"
+#include "testcart.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {Frames = 120, SaveEvery = 10};
+
+typedef struct
+{
+    tic80** tics;
+    void* state;
+    s32 size;
+} Stress;
+
+static void tickJob(void* data, s32 index)
+{
+    Stress* stress = data;
+    tic80* tic = stress->tics[index];
+    tic80_input input;
+
+    memset(&input, 0, sizeof input);
+
+    for(s32 frame = 0; frame < Frames; frame++)
+    {
+        input.gamepads.first.a = frame & 1;
+        tic80_tick(tic, &input);
+
+        if(frame % SaveEvery == SaveEvery - 1)
+        {
+            u8* state = (u8*)stress->state + index * stress->size;
+            s32 size = tic80_save_state(tic, state, stress->size);
+
+            if(size > 0 && size <= stress->size)
+                tic80_load_state(tic, state, size);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    s32 cores = tic_jobs_cores();
+    s32 count = argc > 1 ? atoi(argv[1]) : MAX(cores * 2, 4);
+
+    u8* buffer = malloc(sizeof(tic_cartridge));
+    s32 size = buffer ? saveTestCart(buffer) : 0;
+
+    if(!size || count < 1)
+        return 1;
+
+    tic80_cart* shared = tic80_cart_create(buffer, size);
+
+    Stress stress = {calloc(count, sizeof(tic80*)), NULL, 0};
+
+    for(s32 i = 0; i < count; i++)
+    {
+        tic80* tic = stress.tics[i] = tic80_create(44100);
+
+        if(!tic) return 1;
+
+        // half of them run their own copy of the cart, the others share one
+        if(i & 1)
+            tic80_load_cart(tic, shared);
+        else
+            tic80_load(tic, buffer, size);
+
+        // and every third one rasterizes on threads of its own
+        if(i % 3 == 0)
+            tic80_draw_threads(tic, 2);
+
+        stress.size = MAX(stress.size, tic80_save_state(tic, NULL, 0));
+    }
+
+    // room for the script heap to grow while it runs
+    stress.size += 64 * 1024;
+    stress.state = malloc((size_t)stress.size * count);
+
+    tic_jobs* jobs = tic_jobs_create(cores);
+
+    tic_jobs_run(jobs, tickJob, &stress, count);
+
+    // the batch shares the instances out to its own workers
+    {
+        tic80_batch* batch = tic80_batch_create(cores);
+        tic80_input* inputs = calloc(count, sizeof(tic80_input));
+
+        tic80_batch_tick(batch, stress.tics, inputs, NULL, count, Frames);
+
+        tic80_batch_delete(batch);
+        free(inputs);
+    }
+
+    tic_jobs_close(jobs);
+
+    for(s32 i = 0; i < count; i++)
+        tic80_delete(stress.tics[i]);
+
+    tic80_cart_delete(shared);
+
+    free(stress.state);
+    free(stress.tics);
+    free(buffer);
+
+    printf("tsan test ticked %i instances on %i cores\n", count, cores);
+
+    return 0;
+}